@@ -69,9 +69,9 @@ std::ostream &operator<<(std::ostream &o, const action_t a) {
     case action_t::action_kind_t::decision:
       return o << ", " << lit_to_dimacs(a.l) << " }";
     case action_t::action_kind_t::unit_prop:
-      return o << ", " << lit_to_dimacs(a.l) << ", " << *a.c << " }";
+      return o << ", " << lit_to_dimacs(a.l) << ", #" << a.c << " }";
     case action_t::action_kind_t::halt_conflict:
-      return o << ", " << *a.c << " }";
+      return o << ", #" << a.c << " }";
     default:
       return o << " }";
   }
@@ -1,14 +1,14 @@
 #include <algorithm>
 #include <vector>
 
-#include "cnf.h"
+#include "bce.h"
 #include "debug.h"
 // Blocked clause elimination
 
 bool resolve_taut(const clause_t &c, const clause_t &d, literal_t l) {
   SAT_ASSERT(contains(c, l));
   SAT_ASSERT(contains(d, neg(l)));
-  // we trust that c, d are sorted by the literal absolute values.
+  // we trust that c, d are sorted by variable (occurrences_t sees to it).
   size_t i = 0;
   size_t j = 0;
   while (i < c.size() && j < d.size()) {
@@ -44,62 +44,43 @@ bool resolve_taut(const clause_t &c, const clause_t &d, literal_t l) {
   return false;
 }
 
-std::vector<clause_id> BCE(cnf_t &cnf) {
-  // Prepare the CNF itself by sorting the contents of its clauses.
-  // This does not invalidate our indexing, though it is risky...
-  for (clause_id cid : cnf) {
-    clause_t &c = cnf[cid];
-    std::sort(std::begin(c), std::end(c),
-              [](literal_t l1, literal_t l2) { return var(l1) < var(l2); });
-  }
-
-#if 0
-  std::cout << cnf << std::endl;
-#endif
-  literal_map_t<clause_set_t> literal_to_clauses(max_variable(cnf));
-  for (clause_id cid : cnf) {
-    const clause_t &c = cnf[cid];
-    for (literal_t l : c) {
-      literal_to_clauses[l].push_back(cid);
-    }
-  }
-
-  auto lits = cnf.lit_range();
+// We only look at the candidates' literals, plus (as we go) the negations of
+// the literals in the clauses we remove: taking away a clause with m can only
+// unblock clauses with neg(m).
+size_t BCE(occurrences_t &occ, const std::vector<variable_t> &candidates) {
+  cnf_t &cnf = occ.cnf;
 
   // Create our initial worklist:
+  literal_map_t<uint8_t> queued(occ.max_var);
   std::vector<literal_t> worklist;
-  std::for_each(std::begin(lits), std::end(lits),
-                [&worklist](literal_t l) { worklist.push_back(l); });
-  std::sort(std::begin(worklist), std::end(worklist),
-            [&literal_to_clauses](literal_t l1, literal_t l2) {
-              return literal_to_clauses[l1].size() >
-                     literal_to_clauses[l2].size();
-            });
-
-  // Debugging: make sure I'm sorting in the right order:
+  for (variable_t v : candidates) {
+    for (literal_t l : {lit(v), neg(lit(v))}) {
+      if (occ.count(l)) {
+        worklist.push_back(l);
+        queued[l] = true;
+      }
+    }
+  }
   // Because we pop from the back, we want the last one (the first one we'd
   // pop) have the shortest incidence list.
-#if 0
-  for (literal_t l : worklist) {
-    std::cout << l << ": " << literal_to_clauses[l].size() << std::endl;
-  }
-#endif
+  std::sort(std::begin(worklist), std::end(worklist),
+            [&occ](literal_t l1, literal_t l2) {
+              return occ.count(l1) > occ.count(l2);
+            });
 
-  std::vector<clause_id> result;
+  size_t removed = 0;
 
   // Now we work through our worklist!
   while (!worklist.empty()) {
     literal_t l = worklist.back();
     worklist.pop_back();
+    queued[l] = false;
 
-    auto &CL = literal_to_clauses[l];
-    const auto &DL = literal_to_clauses[neg(l)];
-    const auto orig_size = result.size();
+    // Removing a clause changes the list we'd be walking, so we copy it.
+    const std::vector<clause_id> CL = occ[l];
+    const auto &DL = occ[neg(l)];
 
     for (clause_id cid : CL) {
-      // If we've already eliminated this, skip.
-      if (contains(result, cid)) continue;
-
       bool is_blocked = std::all_of(
           std::begin(DL), std::end(DL), [l, cid, &cnf](clause_id did) {
             return resolve_taut(cnf[cid], cnf[did], l);
@@ -107,30 +88,18 @@ std::vector<clause_id> BCE(cnf_t &cnf) {
 
       if (!is_blocked) continue;
 
-      result.push_back(cid);
-
       for (literal_t m : cnf[cid]) {
-        if (!contains(worklist, neg(m))) {
+        if (!queued[neg(m)]) {
           worklist.push_back(neg(m));
+          queued[neg(m)] = true;
         }
       }
+      occ.eliminate_clause(cid, l);
+      removed++;
     }
-
-    // To facilitate the loop, we remove the clauses
-    // from our own data structure:
-    auto orig_end = result.begin() + orig_size;
-    std::for_each(orig_end, std::end(result), [&](clause_id cid) {
-      for (literal_t l : cnf[cid]) {
-        auto &cl = literal_to_clauses[l];
-        cl.remove(cid);
-        // auto dit = std::remove(std::begin(cl), std::end(cl), cid);
-        // cl.erase(dit, std::end(cl));
-      }
-    });
   }
-  // if (result.size()) std::cerr << "[BCE] Total clauses removed: " <<
-  // result.size() << std::endl; if (result.size()) std::cerr << result.size()
-  // << std::endl;
+  // if (removed) std::cerr << "[BCE] Total clauses removed: " << removed <<
+  // std::endl;
 
-  return result;
+  return removed;
 }
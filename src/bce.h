@@ -1,4 +1,6 @@
 #pragma once
-#include "cnf.h"
+#include "occurrences.h"
 
-std::vector<clause_id> BCE(cnf_t &cnf);
+// Removes the blocked clauses among those with the candidates' literals (and
+// those that become blocked as we go). Returns how many.
+size_t BCE(occurrences_t &occ, const std::vector<variable_t> &candidates);
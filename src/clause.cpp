@@ -1,5 +1,7 @@
 #include "clause.h"
+#include <iostream>
 #include <iterator>
+#include <new>
 #include "settings.h"
 
 // Really a "clause set", we don't promise anything about order.
@@ -59,11 +61,46 @@ size_t clause_set_t::size() const {
   return mem.size();
 }
 
-int64_t clause_t::signature() const {
-  if (sig_computed) {
-    return sig;
+clause_id clause_arena_t::alloc(size_t len) {
+  clause_id cid = mem.size();
+  mem.resize(mem.size() + header_words + len);
+  new (&mem[cid]) clause_t(len);
+  return cid;
+}
+
+void clause_arena_t::free(clause_id cid) {
+  clause_t &c = (*this)[cid];
+  SAT_ASSERT(c.is_alive);
+  c.is_alive = false;
+  wasted += header_words + c.cap;
+}
+
+// Move cid into "to", unless we already have, leaving a forwarding address
+// behind. Either way return where it lives now. Whoever relocates a clause
+// first decides where it lands, so callers go in the order they want the
+// clauses laid out.
+clause_id clause_arena_t::relocate(clause_id cid, clause_arena_t &to) {
+  clause_t &c = (*this)[cid];
+  if (c.relocated) {
+    return c.len;
   }
-  sig_computed = true;
+  SAT_ASSERT(c.is_alive);
+  clause_id nid = to.alloc(c.len);
+  clause_t &d = to[nid];
+  std::copy(c.begin(), c.end(), d.begin());
+  d.learned = c.learned;
+  d.in_worklist = c.in_worklist;
+  d.tier = c.tier;
+  d.used = c.used;
+  d.lbd = c.lbd;
+  d.activity = c.activity;
+  c.relocated = true;
+  c.len = nid;
+  return nid;
+}
+
+int64_t clause_t::signature() const {
+  int64_t sig = 0;
   // auto h = [](literal_t l) { return std::hash<literal_t>{}(l); };
   // auto h = [](literal_t l) { return var(l) % 64; };
   // auto h = [](literal_t l) -> int64_t { return 1 << (var(l) % 64); };
@@ -119,11 +156,11 @@ bool clauses_equal(const clause_t &a, const clause_t &b) {
   return al == bl;
 }
 
-clause_t resolve_ref(const clause_t &c1, const clause_t &c2, literal_t l) {
+std::vector<literal_t> resolve_ref(const clause_t &c1, const clause_t &c2,
+                                  literal_t l) {
   SAT_ASSERT(contains(c1, l));
   SAT_ASSERT(contains(c2, neg(l)));
   std::vector<literal_t> c3tmp;
-  // clause_t c3tmp;
   for (literal_t x : c1) {
     if (var(x) != var(l)) {
       c3tmp.push_back(x);
@@ -167,51 +167,70 @@ struct cache_storage {
   }
 };
 
+// Clauses live inline in a clause_arena_t: a small header immediately
+// followed by the literals, so visiting a clause is a single pointer chase.
+// We never construct one of these on its own (cnf_t::add_clause places them
+// in the arena), so there is no copy or move: hold a clause_id or a reference.
+// References are invalidated when the arena grows, i.e., by add_clause.
 struct clause_t {
-  // cache_storage<literal_t, 16> mem;
-  std::vector<literal_t> mem;
-  clause_t(std::vector<literal_t> m) : mem(m) {}
+  uint32_t len;
+  // How many literal slots follow the header. Literals can be removed in
+  // place (pop_back), so this can exceed len, and is what we use to step to
+  // the next clause in the arena.
+  uint32_t cap;
+  uint32_t is_alive : 1;
+  // Set only in an arena being compacted away: len is then the clause's new
+  // id (see clause_arena_t::relocate).
+  uint32_t relocated : 1;
+  // Learned clauses that DB cleaning may remove (see lbd_t). A clause can
+  // stop being one without leaving the worklist: in_worklist says whether
+  // lbd_t still holds an entry for it.
+  uint32_t learned : 1;
+  uint32_t in_worklist : 1;
+  // Which tier of the learned clause database we're in (lbd_t::tier_t), and
+  // whether we've taken part in conflict analysis since it last looked.
+  uint32_t tier : 2;
+  uint32_t used : 1;
+  // The literal block distance, as of the last time we took part in conflict
+  // analysis (or were learned).
+  uint32_t lbd : 25;
+  // Bumped when we take part in conflict analysis; ranks the local tier.
+  float activity;
 
-  // no copy constructor, only "clone"
-  clause_t(clause_t &&that) = default;
-  clause_t(const lit_compactset_t &s) : mem(std::begin(s), std::end(s)) {}
-  clause_t(const lit_bitset_t &s) {
-    for (literal_t l : literal_range(s.max_var)) {
-      if (s.get(l)) mem.push_back(l);
-    }
-  }
-  clause_t(const lit_bothset_t &s) : clause_t(s.c) {}
-  clause_t &operator=(clause_t &&that) = default;
-
-  clause_t *left = nullptr;
-  clause_t *right = nullptr;
-  bool is_alive = true;
-
-  clause_t clone() const { return clause_t{mem}; }
+  clause_t(uint32_t len)
+      : len(len),
+        cap(len),
+        is_alive(true),
+        relocated(false),
+        learned(false),
+        in_worklist(false),
+        tier(0),
+        used(false),
+        lbd(0),
+        activity(0) {}
+  clause_t(const clause_t &) = delete;
+  clause_t &operator=(const clause_t &) = delete;
 
-  // clause_t() {}
-  // void push_back(literal_t l) { mem.push_back(l); }
+  literal_t *mem() { return reinterpret_cast<literal_t *>(this + 1); }
+  const literal_t *mem() const {
+    return reinterpret_cast<const literal_t *>(this + 1);
+  }
 
-  // template<typename IT>
-  // void erase(IT b, IT e) { mem.erase(b, e); }
-  void clear() { mem.clear(); }
-  auto begin() { return mem.begin(); }
-  auto begin() const { return mem.begin(); }
-  auto end() { return mem.end(); }
-  auto end() const { return mem.end(); }
-  auto size() const { return mem.size(); }
-  auto empty() const { return mem.empty(); }
-  auto &operator[](size_t i) { return mem[i]; }
-  auto &operator[](size_t i) const { return mem[i]; }
-  void pop_back() {
-    mem.pop_back();
-    // mem[mem.len] = 0;
+  void clear() { len = 0; }
+  literal_t *begin() { return mem(); }
+  const literal_t *begin() const { return mem(); }
+  literal_t *end() { return mem() + len; }
+  const literal_t *end() const { return mem() + len; }
+  size_t size() const { return len; }
+  bool empty() const { return len == 0; }
+  literal_t &operator[](size_t i) { return mem()[i]; }
+  const literal_t &operator[](size_t i) const { return mem()[i]; }
+  void pop_back() { len--; }
+  bool operator==(const clause_t &that) const {
+    return std::equal(begin(), end(), that.begin(), that.end());
   }
-  bool operator==(const clause_t &that) const { return mem == that.mem; }
-  bool operator!=(const clause_t &that) const { return mem != that.mem; }
+  bool operator!=(const clause_t &that) const { return !(*this == that); }
 
-  mutable int64_t sig = 0;
-  mutable bool sig_computed = false;
   // For easier subsumption. This is its hash, really
   int64_t signature() const;
   bool possibly_subsumes(const clause_t &that) const;
@@ -223,7 +242,41 @@ inline bool operator<(const clause_t &a, const clause_t &b) {
   return e1 == std::end(a) && e2 != std::end(b);
 }
 
-typedef clause_t *clause_id;
+// A clause is named by its offset (in 32-bit words) into the arena.
+typedef uint32_t clause_id;
+// The arena never hands out offset 0, so that's our "no clause".
+constexpr clause_id null_clause_id = 0;
+
+// One contiguous buffer holding every clause, headers and literals inline.
+// Removed clauses are left in place (just marked dead); we count the words
+// they occupy in "wasted", and once that's a big enough share of the arena
+// it's worth compacting (copying the live clauses into a fresh arena).
+struct clause_arena_t {
+  static constexpr size_t header_words = sizeof(clause_t) / sizeof(uint32_t);
+  std::vector<uint32_t> mem;
+  size_t wasted = 0;
+
+  clause_arena_t() : mem(1) {}
+
+  clause_id alloc(size_t len);
+  void free(clause_id cid);
+  clause_id relocate(clause_id cid, clause_arena_t &to);
+  bool mostly_garbage() const { return wasted > mem.size() * garbage_fraction; }
+  static constexpr float garbage_fraction = 0.2f;
+
+  clause_t &operator[](clause_id cid) {
+    return *reinterpret_cast<clause_t *>(&mem[cid]);
+  }
+  const clause_t &operator[](clause_id cid) const {
+    return *reinterpret_cast<const clause_t *>(&mem[cid]);
+  }
+  clause_id first() const { return 1; }
+  clause_id next(clause_id cid) const {
+    return cid + header_words + (*this)[cid].cap;
+  }
+  clause_id limit() const { return mem.size(); }
+  size_t size_in_bytes() const { return mem.size() * sizeof(uint32_t); }
+};
 
 template <>
 struct std::iterator_traits<
@@ -306,5 +359,6 @@ struct clause_set_t {
 bool clauses_equal(const clause_t &a, const clause_t &b);
 bool clause_taut(const clause_t &c);
 void canon_clause(clause_t &c);
-clause_t resolve_ref(const clause_t &c1, const clause_t &c2, literal_t l);
+std::vector<literal_t> resolve_ref(const clause_t &c1, const clause_t &c2,
+                                  literal_t l);
 std::ostream &operator<<(std::ostream &o, const clause_t &c);
\ No newline at end of file
@@ -39,7 +39,7 @@ bool verify_resolution_expected(const clause_t &c, const trail_t &actions) {
   return true;
 }
 
-clause_t simplest_learning(const trail_t &actions) {
+std::vector<literal_t> simplest_learning(const trail_t &actions) {
   assert(0);
   std::vector<literal_t> new_clause;
   for (action_t a : actions) {
@@ -48,7 +48,7 @@ clause_t simplest_learning(const trail_t &actions) {
     }
   }
   // std::cout << "Learned clause: " << new_clause << std::endl;
-  return clause_t{new_clause};
+  return new_clause;
 }
 
 #if 0
@@ -90,8 +90,9 @@ clause_t explicit_resolution(const cnf_t& cnf, const trail_t& actions) {
 }
 #endif
 
-clause_t stamp_resolution(const cnf_t &cnf, const trail_t &actions,
-                          lit_bitset_t &stamped) {
+std::vector<literal_t> stamp_resolution(const cnf_t &cnf,
+                                        const trail_t &actions,
+                                        lit_bitset_t &stamped) {
   stamped.reset();
 
   std::vector<literal_t> C;
@@ -155,11 +156,11 @@ clause_t stamp_resolution(const cnf_t &cnf, const trail_t &actions,
   // std::cout << "Learned: " << C << std::endl;
   std::sort(std::begin(C), std::end(C));
 
-  return clause_t{C};
+  return C;
 }
 
-clause_t learn_clause(const cnf_t &cnf, const trail_t &actions,
-                      lit_bitset_t &stamped) {
+std::vector<literal_t> learn_clause(const cnf_t &cnf, const trail_t &actions,
+                                   lit_bitset_t &stamped) {
   SAT_ASSERT(actions.rbegin()->action_kind ==
              action_t::action_kind_t::halt_conflict);
   return stamp_resolution(cnf, actions, stamped);
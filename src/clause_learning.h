@@ -4,5 +4,5 @@
 
 enum class learn_mode_t { simplest, explicit_resolution };
 extern learn_mode_t learn_mode;
-clause_t learn_clause(const cnf_t &cnf, const trail_t &actions,
-                      lit_bitset_t &stamped);
+std::vector<literal_t> learn_clause(const cnf_t &cnf, const trail_t &actions,
+                                   lit_bitset_t &stamped);
@@ -9,6 +9,8 @@
 #include <string>
 
 #include "debug.h"
+#include "occurrences.h"
+#include "proof.h"
 #include "settings.h"
 
 std::ostream &operator<<(std::ostream &o, const cnf_t &cnf) {
@@ -27,21 +29,6 @@ variable_t max_variable(const cnf_t &cnf) {
   return m;
 }
 
-clause_id cnf_t::add_clause(clause_t c) {
-  live_count++;
-
-  auto ret = new clause_t(std::move(c));
-
-  if (!head) {
-    head = ret;
-  } else {
-    head->left = ret;
-    ret->right = head;
-    head = ret;
-  }
-  return ret;
-}
-
 void cnf_t::remove_clause_set(const clause_set_t &cs) {
   for (auto cid : cs) {
     remove_clause(cid);
@@ -49,45 +36,42 @@ void cnf_t::remove_clause_set(const clause_set_t &cs) {
 }
 
 void cnf_t::remove_clause(clause_id cid) {
-  if (cid->is_alive) {
+  if (arena[cid].is_alive) {
     live_count--;
-    cid->is_alive = false;
-    if (cid->left) {
-      cid->left->right = cid->right;
-    }
-    if (cid->right) {
-      cid->right->left = cid->left;
-    }
-    if (cid == head) {
-      head = cid->right;
-    }
+    arena.free(cid);
     to_erase.push_back(cid);
   }
 }
 
 void cnf_t::restore_clause(clause_id cid) {
-  SAT_ASSERT(!cid->is_alive);
-  cid->is_alive = true;
+  SAT_ASSERT(!arena[cid].is_alive);
+  arena[cid].is_alive = true;
+  arena.wasted -= clause_arena_t::header_words + arena[cid].cap;
   live_count++;
 
   // Don't remove this!
   auto it = std::remove(std::begin(to_erase), std::end(to_erase), cid);
   to_erase.erase(it, std::end(to_erase));
+}
 
-  if (!head) {
-    head = cid;
-  } else {
-    head->left = cid;
-    cid->right = head;
-    head = cid;
-  }
+// Dead clauses stay in the arena (they're already skipped by iteration), so
+// all we have to forget is the list of pending erasures.
+void cnf_t::clean_clauses() { to_erase.clear(); }
+
+void cnf_t::begin_compaction() {
+  compacted = clause_arena_t();
+  compacted.mem.reserve(arena.mem.size() - arena.wasted);
 }
 
-void cnf_t::clean_clauses() {
-  for (auto cid : to_erase) {
-    delete cid;
+size_t cnf_t::end_compaction() {
+  for (clause_id cid : *this) {
+    relocate(cid);
   }
+  size_t before = arena.size_in_bytes();
+  arena = std::move(compacted);
+  compacted = clause_arena_t();
   to_erase.clear();
+  return before - arena.size_in_bytes();
 }
 
 literal_map_t<clause_set_t> build_incidence_map(const cnf_t &cnf) {
@@ -127,28 +111,13 @@ bool check_incidence_map(const literal_map_t<clause_set_t> &m,
 namespace cnf {
 namespace transform {
 
-void commit_literal(cnf_t &cnf, literal_t l) {
-  std::vector<clause_id> containing_clauses;
-  std::copy_if(std::begin(cnf), std::end(cnf),
-               std::back_inserter(containing_clauses),
-               [&](const clause_id cid) { return contains(cnf[cid], l); });
-  std::for_each(std::begin(containing_clauses), std::end(containing_clauses),
-                [&](const clause_id cid) { cnf.remove_clause(cid); });
-  for (clause_t &c : clauses(cnf)) {
-    auto new_end = std::remove(std::begin(c), std::end(c), neg(l));
-    // c.erase(new_end, std::end(c));
-    auto to_erase = std::distance(new_end, std::end(c));
-    for (auto i = 0; i < to_erase; i++) {
-      c.pop_back();
-    }
-  }
-}
 void canon(cnf_t &cnf) {
   // Remove all tautologies
   std::vector<clause_id> to_remove;
   std::copy_if(std::begin(cnf), std::end(cnf), std::back_inserter(to_remove),
                [&cnf](clause_id cid) { return clause_taut(cnf[cid]); });
   for (auto cid : to_remove) {
+    proof::del(cnf[cid]);
     cnf.remove_clause(cid);
   }
   cnf.clean_clauses();
@@ -196,17 +165,15 @@ void canon(cnf_t &cnf) {
   }
 
   for (auto cid : to_remove) {
+    proof::del(cnf[cid]);
     cnf.remove_clause(cid);
   }
   cnf.clean_clauses();
 }
+// One pass to index the CNF, then each unit costs only its occurrences.
 int apply_trivial_units(cnf_t &cnf) {
-  int hitcount = 0;
-  while (literal_t u = cnf::search::find_unit(cnf)) {
-    commit_literal(cnf, u);
-    hitcount++;
-  }
-  return hitcount;
+  occurrences_t occ(cnf);
+  return occ.propagate_units();
 }
 }  // namespace transform
 
@@ -231,55 +198,6 @@ bool immediately_unsat(const cnf_t &cnf) {
 bool immediately_sat(const cnf_t &cnf) { return cnf.live_clause_count() == 0; }
 }  // namespace search
 
-namespace io {
-bool load_cnf(const char *buffer, size_t s, cnf_t &cnf) {
-  std::vector<literal_t> next_clause_tmp;
-
-  std::string cppbuffer{buffer, s};
-  std::istringstream ss(cppbuffer);
-  std::string line;
-
-  while (std::getline(ss, line)) {
-    std::istringstream ws(line);
-    std::vector<std::string> words;
-    std::copy(std::istream_iterator<std::string>(ws),
-              std::istream_iterator<std::string>(), std::back_inserter(words));
-
-    if (words.size() == 0) continue;
-    if (words[0] == "c") continue;
-    if (words[0] == "p") continue;
-
-    for (const std::string &w : words) {
-      size_t chars_read = 0;
-      literal_t l = 0;
-      try {
-        l = std::stol(w, &chars_read);
-      } catch (std::invalid_argument &) {
-        return false;
-      } catch (std::out_of_range &) {
-        return false;
-      }
-
-      // Parse error: didn't get an int we expected.
-      if (chars_read != w.size()) {
-        return false;
-      }
-
-      if (l == 0) {
-        std::sort(std::begin(next_clause_tmp), std::end(next_clause_tmp));
-        cnf.add_clause(next_clause_tmp);
-        next_clause_tmp.clear();
-      } else {
-        next_clause_tmp.push_back(dimacs_to_lit(l));
-      }
-    }
-  }
-  if (next_clause_tmp.size() > 0) {
-    return false;
-  }
-  return true;
-}
-}  // namespace io
 }  // namespace cnf
 
 // REVIEW: put these in a namespace, too?
@@ -15,38 +15,31 @@
 #include "variable.h"
 
 struct cnf_t {
-  clause_t *head = nullptr;
+  // Every clause (original and learned) lives in this one buffer.
+  clause_arena_t arena;
   size_t live_count = 0;
   std::vector<clause_id> to_erase;
 
-  std::unordered_map<size_t, std::vector<clause_t *>> sig_to_clause;
-
+  // We walk the arena in allocation order, skipping dead clauses.
   struct clause_iterator {
-    clause_t *curr;
+    const clause_arena_t *arena;
+    clause_id curr;
+    void skip_dead() {
+      while (curr != arena->limit() && !(*arena)[curr].is_alive) {
+        curr = arena->next(curr);
+      }
+    }
     clause_id operator*() { return curr; }
-    clause_id operator->() { return curr; }
     clause_iterator operator++() {
-      curr = curr->right;
-      while (curr && !curr->is_alive) curr = curr->right;
+      curr = arena->next(curr);
+      skip_dead();
       return *this;
     }
     clause_iterator operator++(int) {
       auto tmp = *this;
-      curr = curr->right;
-      while (curr && !curr->is_alive) curr = curr->right;
-      return tmp;
-    }
-    clause_iterator operator--(int) {
-      auto tmp = *this;
-      curr = curr->left;
-      while (curr && !curr->is_alive) curr = curr->left;
+      ++(*this);
       return tmp;
     }
-    clause_iterator operator--() {
-      curr = curr->left;
-      while (curr && !curr->is_alive) curr = curr->left;
-      return *this;
-    }
     bool operator==(const clause_iterator &that) const {
       return curr == that.curr;
     }
@@ -55,56 +48,47 @@ struct cnf_t {
     }
   };
 
-  auto begin() const {
-    clause_iterator ci;
-    ci.curr = head;
-    return ci;
-  }
-  auto end() const {
-    clause_iterator ci;
-    ci.curr = nullptr;
-    return ci;
-  }
-  auto begin() {
-    clause_iterator ci;
-    ci.curr = head;
-    return ci;
-  }
-  auto end() {
-    clause_iterator ci;
-    ci.curr = nullptr;
+  clause_iterator begin() const {
+    clause_iterator ci{&arena, arena.first()};
+    ci.skip_dead();
     return ci;
   }
-
-  ~cnf_t() {
-    while (begin() != end()) {
-      remove_clause(*begin());
-    }
-    clean_clauses();
-  }
+  clause_iterator end() const { return {&arena, arena.limit()}; }
 
   cnf_t() = default;
   cnf_t(const cnf_t &cnf) {
-    std::vector<literal_t> tmp;
     for (clause_id cid : cnf) {
-      for (literal_t l : cnf[cid]) {
-        tmp.push_back(l);
-      }
-      add_clause({tmp});
-      tmp.clear();
+      add_clause(cnf[cid]);
     }
   }
 
   size_t live_clause_count() const { return live_count; }
-  clause_t &operator[](clause_id cid) { return *cid; }
-  const clause_t &operator[](clause_id cid) const { return *cid; }
-
-  clause_id add_clause(clause_t c);
+  clause_t &operator[](clause_id cid) { return arena[cid]; }
+  const clause_t &operator[](clause_id cid) const { return arena[cid]; }
+
+  // Any range of literals will do. This may grow the arena, invalidating
+  // outstanding clause_t references (but not clause_ids).
+  template <typename C>
+  clause_id add_clause(const C &c) {
+    clause_id cid = arena.alloc(std::distance(std::begin(c), std::end(c)));
+    std::copy(std::begin(c), std::end(c), std::begin(arena[cid]));
+    live_count++;
+    return cid;
+  }
   void remove_clause_set(const clause_set_t &cs);
   void remove_clause(clause_id cid);
   void restore_clause(clause_id cid);
   void clean_clauses();
 
+  // Compaction: between begin_compaction and end_compaction, everyone holding
+  // clause_ids replaces them with relocate(cid). end_compaction moves any
+  // stragglers (in arena order), swaps in the new arena, and reports how
+  // many bytes that saved.
+  clause_arena_t compacted;
+  void begin_compaction();
+  clause_id relocate(clause_id cid) { return arena.relocate(cid, compacted); }
+  size_t end_compaction();
+
   literal_range lit_range() const {
     variable_t max_variable(const cnf_t &cnf);
     variable_t max_var = max_variable(*this);
@@ -188,7 +172,7 @@ struct std::iterator_traits<cnf_t::clause_iterator> {
   typedef clause_id &reference;
   typedef clause_id *pointer;
   typedef int difference_type;
-  typedef std::bidirectional_iterator_tag iterator_category;
+  typedef std::forward_iterator_tag iterator_category;
 };
 
 template <>
@@ -225,7 +209,6 @@ bool check_incidence_map(const literal_map_t<clause_set_t> &m,
 
 namespace cnf {
 namespace transform {
-void commit_literal(cnf_t &cnf, literal_t l);
 void canon(cnf_t &cnf);
 int apply_trivial_units(cnf_t &cnf);
 }  // namespace transform
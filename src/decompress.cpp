@@ -0,0 +1,260 @@
+#include "decompress.h"
+
+#include <bzlib.h>
+#include <lzma.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cnf {
+namespace io {
+
+namespace {
+constexpr size_t piece_size = 1 << 20;
+
+// Where the compressed bytes come from: a block of memory (the mmapped file,
+// or what we already read to sniff the format), then whatever's left of f.
+struct byte_source_t {
+  const char *mem;
+  size_t len;
+  FILE *f;
+  size_t pos = 0;
+  std::unique_ptr<char[]> buffer;
+
+  // n == 0 means the end of the input. Returns false on a read error.
+  bool next(const char *&p, size_t &n) {
+    if (pos < len) {
+      p = mem + pos;
+      n = std::min(len - pos, piece_size);
+      pos += n;
+      return true;
+    }
+    n = 0;
+    if (!f) return true;
+    if (!buffer) buffer.reset(new char[piece_size]);
+    p = buffer.get();
+    n = fread(buffer.get(), 1, piece_size, f);
+    return !ferror(f);
+  }
+};
+
+// Decompressed text, handed from the decompressing thread to the parser. It's
+// bounded, so a fast decompressor can't run arbitrarily far ahead of us.
+struct chunk_queue_t {
+  static constexpr size_t max_chunks = 4;
+  std::mutex m;
+  std::condition_variable cv;
+  std::deque<std::vector<char>> chunks;
+  bool closed = false;
+  bool ok = true;
+  bool cancelled = false;
+
+  // Returns false if the parser has given up on us.
+  bool push(std::vector<char> &&c) {
+    std::unique_lock<std::mutex> lock(m);
+    cv.wait(lock, [&] { return cancelled || chunks.size() < max_chunks; });
+    if (cancelled) return false;
+    chunks.push_back(std::move(c));
+    cv.notify_all();
+    return true;
+  }
+  // Returns false once everything's been consumed.
+  bool pop(std::vector<char> &c) {
+    std::unique_lock<std::mutex> lock(m);
+    cv.wait(lock, [&] { return closed || !chunks.empty(); });
+    if (chunks.empty()) return false;
+    c = std::move(chunks.front());
+    chunks.pop_front();
+    cv.notify_all();
+    return true;
+  }
+  void close(bool success) {
+    std::lock_guard<std::mutex> lock(m);
+    closed = true;
+    ok = success;
+    cv.notify_all();
+  }
+  void cancel() {
+    std::lock_guard<std::mutex> lock(m);
+    cancelled = true;
+    cv.notify_all();
+  }
+};
+
+// The decompressors write straight into the chunk we're going to hand over.
+struct chunk_writer_t {
+  chunk_queue_t &q;
+  std::vector<char> cur = std::vector<char>(piece_size);
+  size_t used = 0;
+
+  char *out() { return cur.data() + used; }
+  size_t space() const { return cur.size() - used; }
+  bool produced(size_t k) {
+    used += k;
+    return used < cur.size() || flush();
+  }
+  bool flush() {
+    if (used == 0) return true;
+    cur.resize(used);
+    bool ok = q.push(std::move(cur));
+    cur = std::vector<char>(piece_size);
+    used = 0;
+    return ok;
+  }
+};
+
+// Concatenated gzip members are allowed (as gzip -d does). So is anything
+// after the last member that doesn't look like another one, e.g. the zeros
+// padding out a tape block.
+bool gunzip(byte_source_t &in, chunk_writer_t &out) {
+  z_stream z{};
+  if (inflateInit2(&z, 15 + 32) != Z_OK) return false;
+  bool ok = true;
+  bool stream_end = false;
+  bool trailing = false;
+  const char *p;
+  size_t n;
+  while (ok && !trailing && (ok = in.next(p, n)) && n > 0) {
+    z.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(p));
+    z.avail_in = n;
+    while (ok && z.avail_in > 0) {
+      if (stream_end) {
+        if (z.next_in[0] != 0x1f || (z.avail_in > 1 && z.next_in[1] != 0x8b)) {
+          trailing = true;
+          break;
+        }
+        inflateReset(&z);
+        stream_end = false;
+      }
+      z.next_out = reinterpret_cast<Bytef *>(out.out());
+      z.avail_out = out.space();
+      int r = inflate(&z, Z_NO_FLUSH);
+      ok = (r == Z_OK || r == Z_STREAM_END) &&
+           out.produced(out.space() - z.avail_out);
+      stream_end = r == Z_STREAM_END;
+    }
+  }
+  inflateEnd(&z);
+  return ok && stream_end;
+}
+
+bool unxz(byte_source_t &in, chunk_writer_t &out) {
+  lzma_stream s = LZMA_STREAM_INIT;
+  if (lzma_stream_decoder(&s, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) {
+    return false;
+  }
+  bool ok = true;
+  lzma_action action = LZMA_RUN;
+  const char *p;
+  size_t n;
+  for (;;) {
+    if (s.avail_in == 0 && action == LZMA_RUN) {
+      if (!(ok = in.next(p, n))) break;
+      if (n == 0) {
+        action = LZMA_FINISH;
+      } else {
+        s.next_in = reinterpret_cast<const uint8_t *>(p);
+        s.avail_in = n;
+      }
+    }
+    s.next_out = reinterpret_cast<uint8_t *>(out.out());
+    s.avail_out = out.space();
+    lzma_ret r = lzma_code(&s, action);
+    ok = (r == LZMA_OK || r == LZMA_STREAM_END) &&
+         out.produced(out.space() - s.avail_out);
+    if (!ok || r == LZMA_STREAM_END) break;
+  }
+  lzma_end(&s);
+  return ok;
+}
+
+// Like gzip, bzip2 files may be several streams back to back.
+bool bunzip2(byte_source_t &in, chunk_writer_t &out) {
+  bz_stream b{};
+  if (BZ2_bzDecompressInit(&b, 0, 0) != BZ_OK) return false;
+  bool ok = true;
+  bool stream_end = false;
+  const char *p;
+  size_t n;
+  while (ok && (ok = in.next(p, n)) && n > 0) {
+    b.next_in = const_cast<char *>(p);
+    b.avail_in = n;
+    while (ok && b.avail_in > 0) {
+      if (stream_end) {
+        char *next_in = b.next_in;
+        unsigned avail_in = b.avail_in;
+        BZ2_bzDecompressEnd(&b);
+        b = bz_stream{};
+        if (BZ2_bzDecompressInit(&b, 0, 0) != BZ_OK) return false;
+        b.next_in = next_in;
+        b.avail_in = avail_in;
+        stream_end = false;
+      }
+      b.next_out = out.out();
+      b.avail_out = out.space();
+      int r = BZ2_bzDecompress(&b);
+      ok = (r == BZ_OK || r == BZ_STREAM_END) &&
+           out.produced(out.space() - b.avail_out);
+      stream_end = r == BZ_STREAM_END;
+    }
+  }
+  BZ2_bzDecompressEnd(&b);
+  return ok && stream_end;
+}
+}  // namespace
+
+compression_t detect_compression(const char *p, size_t n) {
+  auto starts_with = [&](const char *magic, size_t k) {
+    return n >= k && memcmp(p, magic, k) == 0;
+  };
+  if (starts_with("\x1f\x8b", 2)) return compression_t::gzip;
+  if (starts_with("\xfd" "7zXZ\0", 6)) return compression_t::xz;
+  if (starts_with("BZh", 3)) return compression_t::bzip2;
+  return compression_t::none;
+}
+
+bool load_compressed(compression_t kind, const char *p, size_t n, FILE *f,
+                     dimacs_parser_t &parser) {
+  chunk_queue_t queue;
+  std::thread decompressor([&] {
+    byte_source_t in{p, n, f};
+    chunk_writer_t out{queue};
+    bool ok = false;
+    switch (kind) {
+      case compression_t::gzip:
+        ok = gunzip(in, out);
+        break;
+      case compression_t::xz:
+        ok = unxz(in, out);
+        break;
+      case compression_t::bzip2:
+        ok = bunzip2(in, out);
+        break;
+      case compression_t::none:
+        break;
+    }
+    queue.close(ok && out.flush());
+  });
+
+  bool parsed = true;
+  std::vector<char> chunk;
+  while (queue.pop(chunk)) {
+    if (!parser.feed(chunk.data(), chunk.data() + chunk.size())) {
+      parsed = false;
+      queue.cancel();
+      break;
+    }
+  }
+  decompressor.join();
+  return parsed && queue.ok && parser.finish();
+}
+
+}  // namespace io
+}  // namespace cnf
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+
+#include "dimacs.h"
+
+// Compressed DIMACS inputs (.cnf.gz, .cnf.xz, .cnf.bz2). We go by the magic
+// bytes, not the file name, so this works on stdin too.
+namespace cnf {
+namespace io {
+
+enum class compression_t { none, gzip, xz, bzip2 };
+compression_t detect_compression(const char *p, size_t n);
+
+// Decompresses on a separate thread, handing the text to the parser a chunk at
+// a time as it's produced; we never hold the whole decompressed file. The
+// compressed input is the n bytes at p, followed by the rest of f (if any).
+bool load_compressed(compression_t kind, const char *p, size_t n, FILE *f,
+                     dimacs_parser_t &parser);
+
+}  // namespace io
+}  // namespace cnf
@@ -0,0 +1,176 @@
+#include "dimacs.h"
+#include "decompress.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace cnf {
+namespace io {
+
+namespace {
+bool is_space(char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' ||
+         c == '\f';
+}
+bool is_digit(char c) { return static_cast<unsigned char>(c - '0') < 10; }
+}  // namespace
+
+bool dimacs_parser_t::end_number() {
+  if (!has_digits) {
+    return false;
+  }
+  if (value == 0) {
+    std::sort(std::begin(clause), std::end(clause));
+    cnf.add_clause(clause);
+    clause.clear();
+  } else {
+    int x = static_cast<int>(value);
+    clause.push_back(dimacs_to_lit(negative ? -x : x));
+  }
+  return true;
+}
+
+// This is the only thing standing between a 2GB file and the solver, so it's
+// a hand-rolled state machine over raw characters. Comment and problem lines
+// ("c ...", "p cnf ...") are skipped wholesale; every other token must be an
+// integer.
+bool dimacs_parser_t::feed(const char *p, const char *end) {
+  while (!failed && p != end) {
+    switch (state) {
+      case state_t::skip_line: {
+        p = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (!p) {
+          return true;  // still in the line when the next piece starts.
+        }
+        p++;
+        state = state_t::line_start;
+        break;
+      }
+      case state_t::number: {
+        for (; p != end && is_digit(*p); p++) {
+          value = value * 10 + (*p - '0');
+          has_digits = true;
+          if (value > max_variable) {
+            failed = true;
+            return false;
+          }
+        }
+        if (p == end) {
+          return true;
+        }
+        if (!is_space(*p) || !end_number()) {
+          failed = true;
+          return false;
+        }
+        state = *p == '\n' ? state_t::line_start : state_t::between;
+        p++;
+        break;
+      }
+      case state_t::line_start:
+        if (*p == 'c' || *p == 'p') {
+          state = state_t::skip_line;
+          break;
+        }
+        if (is_space(*p)) {
+          p++;
+          break;
+        }
+        // Otherwise this starts the first number on the line.
+        [[fallthrough]];
+      case state_t::between:
+        if (is_space(*p)) {
+          if (*p == '\n') state = state_t::line_start;
+          p++;
+          break;
+        }
+        value = 0;
+        has_digits = false;
+        negative = *p == '-';
+        if (negative || *p == '+') {
+          p++;
+        } else if (!is_digit(*p)) {
+          failed = true;
+          return false;
+        }
+        state = state_t::number;
+        break;
+    }
+  }
+  return !failed;
+}
+
+bool dimacs_parser_t::finish() {
+  if (failed) {
+    return false;
+  }
+  if (state == state_t::number && !end_number()) {
+    return false;
+  }
+  // An unterminated clause is a parse error.
+  return clause.empty();
+}
+
+bool load_cnf(FILE *f, cnf_t &cnf) {
+#ifndef _WIN32
+  struct stat st;
+  int fd = fileno(f);
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    size_t len = st.st_size;
+    void *m = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m != MAP_FAILED) {
+      madvise(m, len, MADV_SEQUENTIAL);
+      bool ok = load_cnf(static_cast<const char *>(m), len, cnf);
+      munmap(m, len);
+      return ok;
+    }
+  }
+#endif
+  dimacs_parser_t parser(cnf);
+  constexpr size_t buffer_size = 1 << 20;
+  std::unique_ptr<char[]> buffer(new char[buffer_size]);
+  size_t n = fread(buffer.get(), 1, buffer_size, f);
+
+  // The first piece tells us if this is compressed.
+  compression_t kind = detect_compression(buffer.get(), n);
+  if (kind != compression_t::none) {
+    return load_compressed(kind, buffer.get(), n, f, parser);
+  }
+
+  for (; n > 0; n = fread(buffer.get(), 1, buffer_size, f)) {
+    if (!parser.feed(buffer.get(), buffer.get() + n)) {
+      return false;
+    }
+  }
+  if (ferror(f)) {
+    return false;
+  }
+  return parser.finish();
+}
+
+bool load_cnf_file(const char *path, cnf_t &cnf) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    return false;
+  }
+  bool ok = load_cnf(f, cnf);
+  fclose(f);
+  return ok;
+}
+
+bool load_cnf(const char *buffer, size_t s, cnf_t &cnf) {
+  dimacs_parser_t parser(cnf);
+  compression_t kind = detect_compression(buffer, s);
+  if (kind != compression_t::none) {
+    return load_compressed(kind, buffer, s, nullptr, parser);
+  }
+  return parser.feed(buffer, buffer + s) && parser.finish();
+}
+
+}  // namespace io
+}  // namespace cnf
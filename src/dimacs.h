@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "cnf.h"
+
+// Reading DIMACS CNF files. The buffer version, load_cnf, is in cnf.h.
+namespace cnf {
+namespace io {
+
+// An incremental DIMACS scanner. Feed it the input in as many pieces as you
+// like (a number may straddle two pieces), then call finish(). Clauses go into
+// the CNF as soon as their terminating 0 is read, so nothing but the current
+// clause is ever buffered.
+struct dimacs_parser_t {
+  explicit dimacs_parser_t(cnf_t &cnf) : cnf(cnf) {}
+  bool feed(const char *begin, const char *end);
+  bool finish();
+
+  // dimacs_to_lit has to fit 2*v+1 into a literal_t.
+  static constexpr uint64_t max_variable = (1u << 30) - 1;
+
+  cnf_t &cnf;
+  std::vector<literal_t> clause;
+  enum class state_t { line_start, between, number, skip_line };
+  state_t state = state_t::line_start;
+  uint64_t value = 0;
+  bool negative = false;
+  bool has_digits = false;
+  bool failed = false;
+
+  bool end_number();
+};
+
+// Regular files are mmapped and parsed in place. Anything else (pipes, ttys)
+// is streamed through a fixed-size buffer. Either may be gzip, xz, or bzip2
+// compressed (see decompress.h).
+bool load_cnf(FILE *f, cnf_t &cnf);
+bool load_cnf_file(const char *path, cnf_t &cnf);
+
+}  // namespace io
+}  // namespace cnf
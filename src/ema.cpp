@@ -1,4 +1,6 @@
 #include "ema.h"
+
+#include <algorithm>
 void ema_restart_t::reset() {
   alpha_incremental = 1;
   counter = 0;
@@ -29,4 +31,16 @@ void ema_restart_t::step(const size_t lbd) {
   // std::cerr << lbd << "; " << ema_fast << "; " << ema_slow <<
   // std::endl;
   counter++;
-}
\ No newline at end of file
+}
+// reset() leaves all this alone: it's about the search, not this restart.
+void ema_restart_t::block(const size_t trail_size) {
+  conflicts++;
+  if (conflicts > block_after && counter >= 50 &&
+      trail_size > block_factor * ema_trail) {
+    // As if we'd just restarted: it'll take another 50 conflicts.
+    counter = 0;
+  }
+  // Until we have that many samples, this is the plain average.
+  float alpha = std::max(alpha_trail, 1.0f / conflicts);
+  ema_trail = alpha * trail_size + (1.0f - alpha) * ema_trail;
+}
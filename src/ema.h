@@ -10,7 +10,16 @@ struct ema_restart_t {
   float ema_fast = 0;
   float ema_slow = 0;
 
+  // Restart blocking, as in glucose: if the trail is much longer than usual
+  // at a conflict, we may be close to a model, so put off restarting.
+  const float alpha_trail = 1.0 / 5000.0;
+  const float block_factor = 1.4;
+  const size_t block_after = 10000;
+  size_t conflicts = 0;
+  float ema_trail = 0;
+
   void reset();
   bool should_restart() const;
   void step(const size_t lbd);
+  void block(const size_t trail_size);
 };
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "equivalence.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "proof.h"
+#include "solver.h"
+
+equivalences_t::equivalences_t(variable_t max_var)
+    : implies(max_var),
+      representative(max_var),
+      order(max_var),
+      lowlink(max_var),
+      on_stack(max_var) {
+  done.construct(max_var);
+}
+
+void equivalences_t::clear() {
+  for (auto &il : implies) il.clear();
+  contradiction = 0;
+}
+
+void equivalences_t::add_binary(literal_t a, literal_t b) {
+  implies[neg(a)].push_back(b);
+  implies[neg(b)].push_back(a);
+}
+
+size_t equivalences_t::find() {
+  size_t before = substituted;
+  std::fill(std::begin(order), std::end(order), 0);
+  for (literal_t l : literal_range(implies.max_var)) {
+    representative[l] = l;
+  }
+  uint32_t next_order = 1;
+  for (literal_t l : literal_range(implies.max_var)) {
+    // Without edges out, we're on our own anyway.
+    if (!order[l] && !implies[l].empty()) strong_connect(l, next_order);
+  }
+  return substituted - before;
+}
+
+// Each frame is a literal, and how many of its edges we've followed.
+void equivalences_t::strong_connect(literal_t root, uint32_t &next_order) {
+  std::vector<std::pair<literal_t, size_t>> frames;
+  auto visit = [&](literal_t l) {
+    order[l] = lowlink[l] = next_order++;
+    stack.push_back(l);
+    on_stack[l] = true;
+    frames.push_back({l, 0});
+  };
+
+  visit(root);
+  while (!frames.empty()) {
+    literal_t l = frames.back().first;
+    size_t i = frames.back().second++;
+    if (i < implies[l].size()) {
+      literal_t m = implies[l][i];
+      if (!order[m]) {
+        visit(m);
+      } else if (on_stack[m]) {
+        lowlink[l] = std::min(lowlink[l], order[m]);
+      }
+      continue;
+    }
+
+    frames.pop_back();
+    if (!frames.empty()) {
+      literal_t parent = frames.back().first;
+      lowlink[parent] = std::min(lowlink[parent], lowlink[l]);
+    }
+    if (lowlink[l] == order[l]) component(l);
+  }
+}
+
+// The component is everything on the stack from root up.
+void equivalences_t::component(literal_t root) {
+  size_t begin = stack.size();
+  do {
+    begin--;
+  } while (stack[begin] != root);
+  auto first = std::begin(stack) + begin;
+  literal_t rep = *std::min_element(
+      first, std::end(stack),
+      [](literal_t a, literal_t b) { return var(a) < var(b); });
+
+  for (auto it = first; it != std::end(stack); it++) {
+    literal_t m = *it;
+    on_stack[m] = false;
+    if (m == rep) continue;
+    representative[m] = rep;
+    if (var(m) == var(rep)) {
+      contradiction = rep;
+    } else if (ispos(m)) {
+      // Its negation is in the dual component; count the variable once.
+      substituted++;
+    }
+  }
+  stack.erase(first, std::end(stack));
+}
+
+bool equivalences_t::rewrite(const clause_t &c,
+                             std::vector<literal_t> &d) const {
+  d.clear();
+  for (literal_t l : c) d.push_back(representative[l]);
+  std::sort(std::begin(d), std::end(d));
+  d.erase(std::unique(std::begin(d), std::end(d)), std::end(d));
+  // Sorted, a literal's negation is right next to it.
+  for (size_t i = 1; i < d.size(); i++) {
+    if (d[i] == neg(d[i - 1])) return true;
+  }
+  return false;
+}
+
+size_t substitute_equivalences(occurrences_t &occ) {
+  cnf_t &cnf = occ.cnf;
+  equivalences_t eq(occ.max_var);
+  for (clause_id cid : cnf) {
+    const clause_t &c = cnf[cid];
+    if (c.size() == 2) eq.add_binary(c[0], c[1]);
+  }
+  size_t substituted = eq.find();
+  if (eq.contradiction) {
+    // Each of these is implied by the other literal, through the cycle.
+    occ.add_clause({eq.contradiction});
+    occ.add_clause({neg(eq.contradiction)});
+    return 1;
+  }
+  if (!substituted) return 0;
+
+  std::vector<variable_t> vars;
+  std::vector<clause_id> rewriting;
+  std::vector<uint8_t> queued(cnf.arena.limit(), false);
+  for (variable_t v : variable_range(occ.max_var)) {
+    if (eq[lit(v)] == lit(v)) continue;
+    vars.push_back(v);
+    for (literal_t l : {lit(v), neg(lit(v))}) {
+      for (clause_id cid : occ[l]) {
+        if (queued[cid]) continue;
+        queued[cid] = true;
+        rewriting.push_back(cid);
+      }
+    }
+  }
+
+  // (l v -r) and (-l v r), with l and -l as their witnesses.
+  std::vector<std::pair<clause_id, literal_t>> definitions;
+  for (variable_t v : vars) {
+    for (literal_t w : {lit(v), neg(lit(v))}) {
+      std::vector<literal_t> d{w, neg(eq[w])};
+      std::sort(std::begin(d), std::end(d));
+      definitions.push_back({occ.add_clause(d), w});
+    }
+  }
+
+  std::vector<literal_t> d;
+  for (clause_id cid : rewriting) {
+    if (!eq.rewrite(cnf[cid], d)) occ.add_clause(d);
+    occ.remove_clause(cid);
+  }
+
+  // Nothing else mentions our variables now.
+  for (auto [cid, witness] : definitions) {
+    occ.eliminate_clause(cid, witness);
+  }
+  return substituted;
+}
+
+void equivalences_t::install(solver_t &s) {
+  s.conflict_enter.add_listener([&]() { conflicts++; });
+  // As with subsumption: at level 0, we only touch clauses that aren't
+  // reasons.
+  s.full_restart_wanted.push_back([&]() { return due(); });
+  s.restart.add_listener([&]() {
+    if (due()) run_solver(s);
+  });
+}
+
+// Only unassigned literals take part: anything assigned at level 0 is fixed
+// anyway. A contradiction we leave for the search to find.
+void equivalences_t::run_solver(solver_t &s) {
+  cnf_t &cnf = s.cnf;
+  const trail_t &trail = s.trail;
+  MAX_ASSERT(trail.level() == 0);
+
+  auto free = [&](literal_t l) {
+    return trail.literal_unassigned(l) && !done[var(l)];
+  };
+  clear();
+  for (clause_id cid : cnf) {
+    const clause_t &c = cnf[cid];
+    if (c.size() == 2 && free(c[0]) && free(c[1])) add_binary(c[0], c[1]);
+  }
+  // Each run costs us a full restart, so we back off while there's nothing
+  // to find.
+  if (!find() || contradiction) {
+    run_interval *= 2;
+    next_run = conflicts + run_interval;
+    return;
+  }
+
+  std::vector<clause_id> rewriting;
+  for (clause_id cid : cnf) {
+    const clause_t &c = cnf[cid];
+    auto changes = [&](literal_t l) { return representative[l] != l; };
+    auto is_done = [&](literal_t l) { return done[var(l)]; };
+    if (std::any_of(std::begin(c), std::end(c), changes) &&
+        std::none_of(std::begin(c), std::end(c), is_done)) {
+      rewriting.push_back(cid);
+    }
+  }
+
+  std::vector<variable_t> vars;
+  std::vector<literal_t> d;
+  for (variable_t v : variable_range(implies.max_var)) {
+    if (representative[lit(v)] == lit(v)) continue;
+    vars.push_back(v);
+    for (literal_t w : {lit(v), neg(lit(v))}) {
+      d = {w, neg(representative[w])};
+      proof::add(d);
+      s.watch.watch_clause(cnf.add_clause(d));
+    }
+  }
+
+  for (clause_id cid : rewriting) {
+    if (rewrite(cnf[cid], d)) {
+      s.lbd.remove(cid);
+      s.remove_clause(cid);
+      continue;
+    }
+    // We'd rather not find units here, so the clause must stay watchable.
+    auto non_false =
+        std::count_if(std::begin(d), std::end(d),
+                      [&](literal_t l) { return !trail.literal_false(l); });
+    if (non_false < 2) continue;
+
+    clause_t &c = cnf[cid];
+    proof::add(d);
+    proof::del(c);
+    s.watch.remove_clause(cid);
+    for (literal_t &l : c) l = representative[l];
+    canon_clause(c);
+    s.watch.watch_clause(cid);
+  }
+  for (variable_t v : vars) done[v] = true;
+  cnf.clean_clauses();
+  MAX_ASSERT(s.watch.validate_state());
+
+  next_run = conflicts + run_interval;
+}
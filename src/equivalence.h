@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "occurrences.h"
+#include "trail.h"
+
+struct solver_t;
+
+// Equivalent literal substitution. Binary clauses are implications both
+// ways ((a v b) is both -a -> b and -b -> a), and a cycle of implications
+// makes all its literals equivalent. We find them as the strongly connected
+// components of the binary implication graph (Tarjan's algorithm, without
+// recursion), and replace each literal by its component's representative,
+// the literal with the smallest variable. The negated component gets the
+// negated representative, for free.
+//
+// Rewriting a clause is checkable (RUP) as long as the binary clauses saying
+// l <-> r are around, so we add those "definitions" first. In the
+// preprocessor, they're all that's left of l afterwards, and we eliminate
+// them (for model reconstruction). The solver keeps them, so l simply follows
+// r, and substitutes every so often (at a full restart).
+struct equivalences_t {
+  // The binary implication graph: for each literal, those it implies.
+  literal_map_t<std::vector<literal_t>> implies;
+  // Each literal's representative (itself, if it's the only one).
+  literal_map_t<literal_t> representative;
+  // A literal equivalent to its own negation (so, UNSAT), if we found one.
+  literal_t contradiction = 0;
+
+  // Tarjan's bookkeeping: DFS order (0 if unvisited), lowest reachable DFS
+  // order, and the stack of visited literals not yet in a component.
+  literal_map_t<uint32_t> order;
+  literal_map_t<uint32_t> lowlink;
+  literal_map_t<uint8_t> on_stack;
+  std::vector<literal_t> stack;
+
+  size_t substituted = 0;
+
+  explicit equivalences_t(variable_t max_var);
+
+  void add_binary(literal_t a, literal_t b);
+  // Finds the components, and returns how many variables we can substitute.
+  size_t find();
+  literal_t operator[](literal_t l) const { return representative[l]; }
+  // c with each literal replaced by its representative, sorted and without
+  // duplicates. Says whether that's a tautology.
+  bool rewrite(const clause_t &c, std::vector<literal_t> &d) const;
+
+  // For inprocessing: counted in conflicts.
+  size_t conflicts = 0;
+  size_t next_run = 3000;
+  size_t run_interval = 3000;
+  // Variables the solver has already substituted. Beyond their definitions,
+  // they're only left in clauses we couldn't rewrite (and those learned
+  // since), and we leave them all alone.
+  var_map_t<uint8_t> done;
+
+  void install(solver_t &s);
+  bool due() const { return conflicts >= next_run; }
+  void run_solver(solver_t &s);
+
+  void clear();
+  void strong_connect(literal_t root, uint32_t &next_order);
+  void component(literal_t root);
+};
+
+// Substitutes equivalent literals throughout the CNF. Returns how many
+// variables went.
+size_t substitute_equivalences(occurrences_t &occ);
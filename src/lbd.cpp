@@ -6,53 +6,66 @@
 void lbd_t::install(solver_t &s) {
   // This is when we (may) clean the DB
   s.before_decision.add_listener([&](cnf_t &cnf) {
-    if (should_clean(cnf)) {
-      auto to_remove = clean();
-      // don't remove things on the trail
-      auto et = std::remove_if(
-          std::begin(to_remove), std::end(to_remove),
-          [&](clause_id cid) { return s.trail.uses_clause(cid); });
-
-      // erase those
-      while (std::end(to_remove) != et) to_remove.pop_back();
-
+    if (should_clean()) {
+      auto to_remove = clean(s.trail);
       for (auto cid : to_remove) s.remove_clause(cid);
 
       cnf.clean_clauses();
     }
   });
 
+  s.relocate_clauses.add_listener([&](cnf_t &cnf) {
+    clean_worklist();
+    for (auto &cid : worklist) {
+      cid = cnf.relocate(cid);
+    }
+  });
+
+  // Everything conflict analysis resolves with (starting with the conflict
+  // itself) is "used".
+  s.conflict_enter.add_listener(
+      [&]() { clause_used(s.trail.rbegin()->get_clause(), s.trail); });
+  s.cdcl_resolve.core.mark_used = true;
+
   // This is when we note the LBD of the learned clause:
   s.added_clause.add([&](const trail_t &trail, clause_id cid) {
     push_value(s.cnf[cid], trail);
     flush_value(cid);
+    clause_learned();
   });
 }
 
-bool lbd_t::should_clean(const cnf_t &cnf) {
-  return max_size <= cnf.live_clause_count();
-}
+bool lbd_t::should_clean() const { return conflicts >= next_reduce; }
 
+// Tombstone the clause: its worklist entry stays put until clean_worklist.
 bool lbd_t::remove(clause_id cid) {
-  auto it = std::find_if(std::begin(worklist), std::end(worklist),
-                         [&](lbd_entry &e) { return e.id == cid; });
-  if (it != std::end(worklist)) {
-    *it = *std::prev(std::end(worklist));
-    worklist.pop_back();
-    return true;
-  }
-  return false;
+  clause_t &c = cnf[cid];
+  bool was_learned = c.learned;
+  c.learned = false;
+  return was_learned;
+}
+
+lbd_t::tier_t lbd_t::tier_for(size_t lbd) {
+  if (lbd <= core_lbd) return core;
+  if (lbd <= tier2_lbd) return tier2;
+  return local;
 }
 
-size_t lbd_t::compute_value(const clause_t &c, const trail_t &trail) const {
-  static std::vector<char> level_present(trail.level() + 1);
-  level_present.resize(trail.level() + 1);
-  std::fill(std::begin(level_present), std::end(level_present), false);
+// Rather than clearing a "seen" flag per level each time, we mark a level
+// with the current stamp: anything else is unseen. We stop counting once we
+// reach limit (the caller can't use anything bigger).
+size_t lbd_t::compute_value(const clause_t &c, const trail_t &trail,
+                            size_t limit) {
+  if (level_stamp.size() <= trail.level()) {
+    level_stamp.resize(trail.level() + 1, 0);
+  }
+  stamp++;
   size_t value = 0;
   for (literal_t l : c) {
-    if (!level_present[trail.level(l)]) {
-      level_present[trail.level(l)] = true;
-      value++;
+    size_t &s = level_stamp[trail.level(l)];
+    if (s != stamp) {
+      s = stamp;
+      if (++value >= limit) break;
     }
   }
   return value;
@@ -64,33 +77,108 @@ void lbd_t::push_value(const clause_t &c, const trail_t &trail) {
 }
 void lbd_t::flush_value(clause_id cid) {
   SAT_ASSERT(value_cache != 0);
-  // worklist.push({value_cache, cid});
-  worklist.push_back({value_cache, cid});
+  clause_t &c = cnf[cid];
+  c.lbd = std::min<size_t>(value_cache, (1 << 25) - 1);
+  c.tier = tier_for(c.lbd);
+  // Give new clauses a full window before they can be demoted.
+  c.used = true;
+  c.activity = bump;
+  c.learned = true;
+  // A clause we tombstoned may come back (OTF subsumption re-adds it), and
+  // still has its old entry.
+  if (!c.in_worklist) {
+    c.in_worklist = true;
+    worklist.push_back(cid);
+  }
   // value_cache = 0; this isn't needed, and is actually a problem.
 }
 
-lbd_t::lbd_t(const cnf_t &cnf) {
-  max_size = static_cast<size_t>(cnf.live_clause_count() * start_growth);
+// All of c's literals are assigned here (it's the conflict, or a reason), so
+// its LBD is as meaningful as when it was learned.
+void lbd_t::clause_used(clause_id cid, const trail_t &trail) {
+  clause_t &c = cnf[cid];
+  if (!c.learned) return;
+  c.used = true;
+  c.activity += bump;
+  if (c.activity > 1e20f) {
+    for (clause_id d : worklist) {
+      cnf[d].activity *= 1e-20f;
+    }
+    bump *= 1e-20f;
+  }
+  if (c.lbd > core_lbd) {
+    size_t value = compute_value(c, trail, c.lbd);
+    if (value < c.lbd) {
+      c.lbd = value;
+      c.tier = std::min<uint32_t>(c.tier, tier_for(value));
+    }
+  }
+}
+
+void lbd_t::clause_learned() {
+  conflicts++;
+  bump /= decay;
+  if (conflicts >= next_tier2_check) {
+    demote_unused();
+    next_tier2_check = conflicts + tier2_interval;
+  }
+}
+
+void lbd_t::demote_unused() {
+  for (clause_id cid : worklist) {
+    clause_t &c = cnf[cid];
+    if (c.tier == tier2 && !c.used) {
+      c.tier = local;
+    }
+    c.used = false;
+  }
 }
 
-clause_set_t lbd_t::clean() {
+lbd_t::lbd_t(cnf_t &cnf) : cnf(cnf) {}
+
+// Remove the least active clauses of the local tier, except for reasons (those
+// stay on for the next round).
+clause_set_t lbd_t::clean(const trail_t &trail) {
   clean_worklist();
-  size_t target_size = worklist.size() / 2;
+  next_reduce = conflicts + reduce_interval;
+  reduce_interval += reduce_increment;
 
-  std::sort(std::begin(worklist), std::end(worklist), entry_cmp);
+  static std::vector<clause_id> candidates;
+  candidates.clear();
+  for (clause_id cid : worklist) {
+    const clause_t &c = cnf[cid];
+    if (c.tier != local) continue;
+    MAX_ASSERT(trail.is_reason(cid, c) == trail.uses_clause(cid));
+    if (trail.is_reason(cid, c)) continue;
+    candidates.push_back(cid);
+  }
+
+  // We only need the partition, not the order.
+  size_t target_size = candidates.size() * reduce_fraction;
+  std::nth_element(std::begin(candidates),
+                   std::begin(candidates) + target_size, std::end(candidates),
+                   [&](clause_id a, clause_id b) {
+                     return cnf[a].activity < cnf[b].activity;
+                   });
   clause_set_t to_remove;
-  std::for_each(std::begin(worklist) + target_size, std::end(worklist),
-                [&](auto &e) { to_remove.push_back(e.id); });
+  std::for_each(std::begin(candidates), std::begin(candidates) + target_size,
+                [&](clause_id cid) {
+                  cnf[cid].learned = false;
+                  to_remove.push_back(cid);
+                });
   std::sort(std::begin(to_remove), std::end(to_remove));
 
-  worklist.erase(std::begin(worklist) + target_size, std::end(worklist));
-  max_size = static_cast<size_t>(max_size * growth);
+  clean_worklist();
   return to_remove;
 }
 
 void lbd_t::clean_worklist() {
-  auto new_end =
-      std::remove_if(std::begin(worklist), std::end(worklist),
-                     [](const lbd_entry &p) { return !p.id->is_alive; });
+  auto new_end = std::remove_if(std::begin(worklist), std::end(worklist),
+                                [&](clause_id cid) {
+                                  clause_t &c = cnf[cid];
+                                  if (c.is_alive && c.learned) return false;
+                                  c.in_worklist = false;
+                                  return true;
+                                });
   worklist.erase(new_end, std::end(worklist));
-}
\ No newline at end of file
+}
@@ -1,44 +1,68 @@
 #pragma once
 #include <algorithm>
-#include <queue>
+#include <cstdint>
+#include <vector>
 #include "cnf.h"
 #include "trail.h"
 // Literal block distance, for glue clauses
 // Keeps track of the metrics, too.
-
-struct lbd_entry {
-  size_t score;
-  clause_id id;
-};
-static inline bool entry_cmp(const lbd_entry &e1, const lbd_entry &e2) {
-  return e1.score < e2.score;
-}
+//
+// Learned clauses are kept in three tiers, by their LBD:
+//  - core: glue clauses (LBD <= core_lbd), kept forever.
+//  - tier2: kept as long as they take part in conflict analysis at least
+//           once every tier2_interval conflicts, else demoted to local.
+//  - local: every reduce_interval conflicts, the least active clauses go.
+// A clause's LBD is recomputed whenever it takes part in conflict analysis,
+// and it's promoted if that improves.
 
 struct solver_t;
 
 struct lbd_t {
-  // Don't erase anything here!
-  // std::priority_queue<lbd_entry> worklist;
-  std::vector<lbd_entry> worklist;
+  enum tier_t : uint32_t { core = 0, tier2 = 1, local = 2 };
+  static constexpr size_t core_lbd = 2;
+  static constexpr size_t tier2_lbd = 4;
+
+  // The learned clauses we may clean (of all tiers). Their scores live in the
+  // clause headers, and removal just clears clause_t::learned: such
+  // tombstones are dropped by clean_worklist.
+  std::vector<clause_id> worklist;
   size_t value_cache = 0;
 
-  size_t max_size = 0;
-  float growth = 1.05f;
-  float start_growth = 1.2f;
-  bool my_erasure = false;
+  // Counted in conflicts (i.e., learned clauses).
+  size_t conflicts = 0;
+  size_t next_reduce = 300;
+  size_t reduce_interval = 300;
+  size_t reduce_increment = 100;
+  size_t next_tier2_check = 2000;
+  size_t tier2_interval = 2000;
+  // How much of the local tier each reduction removes.
+  float reduce_fraction = 0.75f;
+
+  // Clause activity, as in EVSIDS: we grow the bump rather than decaying
+  // everyone.
+  float bump = 1.0f;
+  float decay = 0.999f;
 
-  // We clean whenever we've since doubled in size.
-  bool should_clean(const cnf_t &cnf);
+  bool should_clean() const;
 
-  clause_set_t clean();
+  clause_set_t clean(const trail_t &trail);
   void clean_worklist();
+  void demote_unused();
 
-  size_t compute_value(const clause_t &c, const trail_t &trail) const;
+  static tier_t tier_for(size_t lbd);
+  // Per decision level, the stamp of the last compute_value to see it.
+  std::vector<size_t> level_stamp;
+  size_t stamp = 0;
+  size_t compute_value(const clause_t &c, const trail_t &trail,
+                       size_t limit = SIZE_MAX);
 
   void push_value(const clause_t &c, const trail_t &trail);
   void flush_value(clause_id cid);
+  void clause_used(clause_id cid, const trail_t &trail);
+  void clause_learned();
 
   bool remove(clause_id cid);
-  lbd_t(const cnf_t &cnf);
+  cnf_t &cnf;
+  lbd_t(cnf_t &cnf);
   void install(solver_t &);
 };
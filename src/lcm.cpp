@@ -1,4 +1,5 @@
-#include <functional>
+#include <cstdint>
+#include <vector>
 
 #include "action.h"
 #include "cnf.h"
@@ -89,90 +90,107 @@ void action_work_list_method(const cnf_t &cnf, clause_t &c,
   std::sort(std::begin(c), std::end(c));
 }
 
+// MiniSat-style recursive minimization: a literal of c is redundant if its
+// reason's other literals are all in c, or (recursively) redundant. The DFS is
+// iterative, and we cache the answer per variable in a mark array that we
+// clear only where we touched it. Also as in MiniSat, we don't bother
+// exploring past a literal whose decision level has no literal in c: a 32-bit
+// "abstract level" mask of c's levels rules most of those out cheaply.
+namespace {
+enum mark_t : uint8_t { unmarked = 0, in_clause, removable, poison };
+
+struct frame_t {
+  variable_t v;
+  const clause_t *reason;
+  uint32_t i;
+};
+
+uint32_t abstract_level(const trail_t &trail, literal_t l) {
+  return uint32_t(1) << (trail.level(l) & 31);
+}
+}  // namespace
+
 void lcm_cache_dfs(const cnf_t &cnf, clause_t &c, const trail_t &actions) {
-  static lit_bitset_t not_removable(max_variable(cnf));
-  static lit_bitset_t removable(max_variable(cnf));
-  static lit_bitset_t inclause(max_variable(cnf));
-  not_removable.reset();
-  removable.reset();
-  inclause.reset();
+  static std::vector<uint8_t> mark;
+  static std::vector<variable_t> touched;
+  static std::vector<frame_t> stack;
+  // (Not max_variable(cnf): that's a scan of the CNF.)
+  const size_t max_var = actions.vardata.max_var;
+  if (mark.size() <= max_var) {
+    mark.resize(max_var + 1, unmarked);
+  }
 
+  uint32_t levels = 0;
   for (literal_t l : c) {
-    inclause.set(l);
+    mark[var(l)] = in_clause;
+    touched.push_back(var(l));
+    levels |= abstract_level(actions, l);
   }
 
-  // This is a recursive DFS, but we also cache results
-  // along the way.
-  std::function<bool(literal_t)> explore = [&](literal_t l) -> bool {
-    // Have we already computed the answer?
-    if (not_removable.get(l)) {
-      return false;
-    }
-    if (removable.get(l)) {
-      return true;
-    }
-
-    // If we're already in c, we're done.
-    // if (contains(c, l)) {
-    if (inclause.get(l)) {
-      removable.set(l);
-      return true;
-    }
-
+  auto reason = [&](literal_t l) -> const clause_t * {
     action_t a = actions.cause(neg(l));
+    if (a.is_decision()) return nullptr;
+    SAT_ASSERT(a.is_unit_prop());
+    return &cnf[a.get_clause()];
+  };
 
-    // If we're a decision, we're not removable.
-    if (a.is_decision()) {
-      not_removable.set(l);
-      return false;
-    }
-
-    // If we have a reason, we're removable
-    // only if everything else is.
-    const clause_t &d = cnf[a.get_clause()];
-    for (literal_t p : d) {
-      if (p == neg(l)) continue;
-      if (!explore(p)) {
-        not_removable.set(l);
+  // Is l (a literal of c) implied by the rest of c?
+  auto redundant = [&](literal_t l, const clause_t *r) -> bool {
+    stack.clear();
+    stack.push_back({var(l), r, 0});
+    while (!stack.empty()) {
+      frame_t &f = stack.back();
+      if (f.i == f.reason->size()) {
+        // Everything this one depends on is removable.
+        if (stack.size() > 1) {
+          mark[f.v] = removable;
+          touched.push_back(f.v);
+        }
+        stack.pop_back();
+        continue;
+      }
+      literal_t p = (*f.reason)[f.i++];
+      variable_t u = var(p);
+      if (u == f.v || actions.level(p) == 0) continue;
+      if (mark[u] == in_clause || mark[u] == removable) continue;
+
+      const clause_t *d = nullptr;
+      if (mark[u] != poison && (abstract_level(actions, p) & levels)) {
+        d = reason(p);
+      }
+      if (!d) {
+        // Neither u nor anything on the stack (but the root, which is in c)
+        // is removable.
+        if (mark[u] == unmarked) {
+          mark[u] = poison;
+          touched.push_back(u);
+        }
+        for (size_t k = 1; k < stack.size(); k++) {
+          mark[stack[k].v] = poison;
+          touched.push_back(stack[k].v);
+        }
         return false;
       }
+      stack.push_back({u, d, 0});
     }
-
-    removable.set(l);
     return true;
   };
 
   for (size_t i = 0; i < c.size(); i++) {
     literal_t l = c[i];
 
-    action_t a = actions.cause(neg(l));
-
-    // We can't launch straight into the recursion yet
-    // because we can't say l is removable just because
-    // it's in c.
-
-    if (a.is_decision()) {
-      not_removable.set(neg(l));
-      continue;
-    }
+    const clause_t *r = reason(l);
+    if (!r) continue;
 
-    bool removable = true;
-
-    const clause_t &d = cnf[a.get_clause()];
-    for (literal_t p : d) {
-      if (p == neg(l)) continue;
-      if (!explore(p)) {
-        removable = false;
-        break;
-      }
-    }
-
-    if (removable) {
+    if (redundant(l, r)) {
       std::swap(c[i], c[c.size() - 1]);
       c.pop_back();
       i--;
     }
   }
+
+  for (variable_t v : touched) mark[v] = unmarked;
+  touched.clear();
   std::sort(std::begin(c), std::end(c));
 }
 
@@ -0,0 +1,71 @@
+#include "lrb.h"
+
+#include <algorithm>
+
+lrb_t::lrb_t(const cnf_t &cnf, const trail_t &trail)
+    : trail(trail), cnf(cnf), heap(cnf, trail) {
+  variable_t max_var = max_variable(cnf);
+  assigned_at.construct(max_var);
+  participated.construct(max_var);
+  reasoned.construct(max_var);
+  seen_at.construct(max_var);
+  std::fill(std::begin(assigned_at), std::end(assigned_at), 0);
+  std::fill(std::begin(participated), std::end(participated), 0);
+  std::fill(std::begin(reasoned), std::end(reasoned), 0);
+  std::fill(std::begin(seen_at), std::end(seen_at), UINT64_MAX);
+  // Everyone starts even: no rewards yet.
+  heap.clear_activity();
+  heap.rebuild();
+}
+
+void lrb_t::assigned(variable_t v) {
+  assigned_at[v] = conflicts;
+  participated[v] = 0;
+  reasoned[v] = 0;
+}
+
+// Implied literals we never got to propagate were never assigned(), so they
+// have no interval to reward.
+void lrb_t::unassigned(variable_t v, bool propagated) {
+  uint64_t interval = conflicts - assigned_at[v];
+  if (propagated && interval > 0) {
+    double reward = double(participated[v] + reasoned[v]) / interval;
+    heap.activity[v] = (1 - alpha) * heap.activity[v] + alpha * reward;
+    heap.update(v);
+  }
+  heap.unassigned(v);
+}
+
+void lrb_t::participate(variable_t v) {
+  if (seen_at[v] == conflicts) return;
+  seen_at[v] = conflicts;
+  participated[v]++;
+}
+
+void lrb_t::conflict(const clause_t &c) {
+  for (literal_t l : c) participate(var(l));
+}
+
+void lrb_t::resolved(literal_t l, const clause_t &reason) {
+  for (literal_t m : reason) participate(var(m));
+}
+
+// Everything on the reason side of the learned clause (i.e., in the reasons
+// of its literals), but not in the conflict analysis itself, gets "reasoned",
+// once per conflict however many of those reasons it's in.
+void lrb_t::clause_learned(const clause_t &c) {
+  for (literal_t l : c) {
+    const action_t &a = trail.cause(neg(l));
+    if (!a.is_unit_prop()) continue;
+    for (literal_t m : cnf[a.get_clause()]) {
+      variable_t v = var(m);
+      if (seen_at[v] == conflicts) continue;
+      seen_at[v] = conflicts;
+      reasoned[v]++;
+    }
+  }
+  conflicts++;
+  alpha = std::max(alpha_min, alpha - alpha_step);
+}
+
+literal_t lrb_t::choose() { return heap.choose(); }
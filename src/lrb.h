@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+#include "vsids.h"
+
+// Learning-rate branching (LRB), as in MapleSAT. We treat choosing a variable
+// as a bandit problem: a variable's reward for the interval it was assigned
+// is the fraction of the conflicts in that interval it took part in (plus
+// the fraction it was on the reason side of, the "reason-side rate"). Its
+// score q is an EMA of these, which we update as it's unassigned. We decide
+// on the unassigned variable with the highest q, kept in a vsids_heap_t
+// (whose activity is our q; we never bump it).
+struct lrb_t {
+  lrb_t(const cnf_t &cnf, const trail_t &trail);
+  void assigned(variable_t v);
+  void unassigned(variable_t v, bool propagated);
+  void conflict(const clause_t &c);
+  void resolved(literal_t l, const clause_t &reason);
+  void clause_learned(const clause_t &c);
+  literal_t choose();
+
+  // The step size, which goes from alpha down to alpha_min, by alpha_step
+  // every conflict.
+  double alpha = 0.4;
+  const double alpha_min = 0.06;
+  const double alpha_step = 1e-6;
+
+  const trail_t &trail;
+  const cnf_t &cnf;
+  vsids_heap_t heap;
+
+  // All counted in conflicts.
+  uint64_t conflicts = 0;
+  var_map_t<uint64_t> assigned_at;
+  var_map_t<uint64_t> participated;
+  var_map_t<uint64_t> reasoned;
+  // The conflict a variable was last counted in (as participating, or on the
+  // reason side).
+  var_map_t<uint64_t> seen_at;
+
+  void participate(variable_t v);
+};
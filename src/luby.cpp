@@ -0,0 +1,17 @@
+#include "luby.h"
+void luby_restart_t::reset() {
+  u = 1;
+  v = 1;
+  conflicts = 0;
+}
+void luby_restart_t::next() {
+  if ((u & -u) == v) {
+    u++;
+    v = 1;
+  } else {
+    v *= 2;
+  }
+  conflicts = 0;
+}
+bool luby_restart_t::should_restart() const { return conflicts >= v * unit; }
+void luby_restart_t::step() { conflicts++; }
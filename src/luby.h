@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+// Restarts on the Luby sequence (1 1 2 1 1 2 4 1 1 2 ...) times unit
+// conflicts, computed with Knuth's "reluctant doubling" pair (u, v): v is the
+// current term.
+struct luby_restart_t {
+  const size_t unit = 512;
+
+  size_t u = 1;
+  size_t v = 1;
+  size_t conflicts = 0;
+
+  void reset();
+  void next();
+  bool should_restart() const;
+  void step();
+};
@@ -25,7 +25,6 @@ enum class solver_action {
   preprocessor_start,
   preprocessor_end,
   apply_unit,
-  skip_unit,
   apply_decision,
   restart,
   determined_conflict_clause,  // 6
@@ -40,6 +39,8 @@ enum class solver_action {
   vivification_case_2a_post,
   vivification_case_2b_pre,
   vivification_case_2b_post,
+
+  garbage_collection,
 };
 
 template <typename T>
@@ -71,7 +72,7 @@ inline void log_action_element(const size_t& l) {
 }
 template <>
 inline void log_action_element(const clause_id& cid) {
-  printf("%p ", cid);
+  printf("#%u ", cid);
 }
 template <>
 inline void log_action_element(const char& c) {
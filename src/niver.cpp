@@ -1,181 +1,199 @@
-#include <map>
-#include "cnf.h"
+#include <algorithm>
+#include <cstdint>
+
+#include "occurrences.h"
+
+// Bounded variable elimination, as in SatELite. Eliminating v replaces every
+// clause with v (or neg(v)) by all their non-tautological resolvents on v. We
+// only do that when it doesn't add clauses, and no resolvent is too long.
+//
+// Variables are tried cheapest first (by the product of their occurrence
+// counts), and again whenever an elimination changes their occurrences. We
+// count resolvents before making any, and stop counting as soon as we're over
+// the bound; tautologies are spotted with literal marks, so counting
+// allocates nothing.
 class NIVER {
-  struct metrics_t {
-    size_t tauts_found = 0;
-    size_t resolvents_tried = 0;
-  };
-
-  metrics_t metrics;
+  occurrences_t &occ;
   cnf_t &cnf;
-  size_t cnf_size = 0;
-
-  literal_map_t<clause_set_t> literals_to_clauses;
-  literal_map_t<size_t> occurrence_count;
 
-  const float growth_factor = 1.0;
+  // With more occurrences than this (of either literal) we don't even try.
+  static constexpr size_t occurrence_limit = 100;
+  static constexpr size_t resolvent_limit = 20;
 
-  mutable clause_set_t cp, cn;
-  mutable std::vector<clause_t> r;
+  // A min-heap by cost, and where each variable is in it (-1 if it isn't).
+  std::vector<variable_t> heap;
+  var_map_t<int> heap_index;
 
-  struct entry_t {
-    variable_t v;
-    size_t count;
-    bool operator<(const entry_t &e) const { return count < e.count; }
-  };
+  literal_map_t<uint8_t> marks;
+  std::vector<std::vector<literal_t>> resolvents;
+  std::vector<variable_t> neighbors;
 
-  bool is_taut(const clause_t &c) const {
-    for (auto it = std::begin(c); it != std::end(c); it++) {
-      for (auto jt = std::next(it); jt != std::end(c); jt++) {
-        if (*it == neg(*jt)) {
-          return true;
-        }
-      }
-    }
-    return false;
+  size_t cost(variable_t v) const {
+    return occ.count(lit(v)) * occ.count(neg(lit(v)));
   }
+  bool before(variable_t a, variable_t b) const { return cost(a) < cost(b); }
 
-  void remove_clause(clause_id cid) {
-    for (literal_t l : cnf[cid]) {
-      literals_to_clauses[l].remove(cid);
+  void sift_up(size_t i) {
+    variable_t v = heap[i];
+    while (i > 0 && before(v, heap[(i - 1) / 2])) {
+      heap[i] = heap[(i - 1) / 2];
+      heap_index[heap[i]] = i;
+      i = (i - 1) / 2;
     }
-    cnf.remove_clause(cid);
+    heap[i] = v;
+    heap_index[v] = i;
   }
-  void add_clause(clause_t &&c) {
-    auto cid = cnf.add_clause(std::move(c));
-    for (literal_t l : cnf[cid]) {
-      literals_to_clauses[l].push_back(cid);
-    }
-  }
-
- public:
-  std::vector<entry_t> worklist;
-  NIVER(cnf_t &cnf, float growth_factor)
-      : cnf(cnf),
-        literals_to_clauses(max_variable(cnf)),
-        occurrence_count(max_variable(cnf)),
-        growth_factor(growth_factor) {
-    // build a mapping of literals to clauses.
-
-    for (clause_id cid : cnf) {
-      SAT_ASSERT(!is_taut(cnf[cid]));
-      const clause_t &c = cnf[cid];
-
-      cnf_size += c.size();
-
-      for (literal_t l : c) {
-        occurrence_count[var(l)]++;
-        SAT_ASSERT(!contains(literals_to_clauses[l], cid));
-        literals_to_clauses[l].push_back(cid);
+  void sift_down(size_t i) {
+    variable_t v = heap[i];
+    for (;;) {
+      size_t child = 2 * i + 1;
+      if (child >= heap.size()) break;
+      if (child + 1 < heap.size() && before(heap[child + 1], heap[child])) {
+        child++;
       }
+      if (!before(heap[child], v)) break;
+      heap[i] = heap[child];
+      heap_index[heap[i]] = i;
+      i = child;
     }
+    heap[i] = v;
+    heap_index[v] = i;
+  }
 
-    for (literal_t l : cnf.lit_range()) {
-      auto &cl = literals_to_clauses[l];
-      std::sort(std::begin(cl), std::end(cl));
-      SAT_ASSERT(std::unique(std::begin(cl), std::end(cl)) == std::end(cl));
-    }
-
-    for (variable_t v : cnf.var_range()) {
-      worklist.push_back({v, occurrence_count[v]});
+  // c's literals (but the one we resolve on) are marked. Returns the size of
+  // the resolvent with d, or SIZE_MAX if it's a tautology.
+  size_t resolvent_size(const clause_t &c, const clause_t &d,
+                        literal_t on) const {
+    size_t size = c.size() - 1;
+    for (literal_t l : d) {
+      if (l == on) continue;
+      if (marks[neg(l)]) return SIZE_MAX;
+      if (!marks[l]) size++;
+    }
+    return size;
+  }
+  void mark(const clause_t &c, literal_t except, bool value) {
+    for (literal_t l : c) {
+      if (l != except) marks[l] = value;
     }
-    std::sort(std::begin(worklist), std::end(worklist));
   }
 
-  bool report_possibility(variable_t v) const {
+  // Are there few enough resolvents (and none too long)?
+  bool within_bounds(variable_t v) {
     literal_t p = lit(v);
     literal_t n = neg(p);
-    // These collections will transform when we remove clauses,
-    // so make a copy
-    const auto &CP = literals_to_clauses[p];
-    const auto &CN = literals_to_clauses[n];
-
-    size_t csize = 0;
-    for (auto pid : CP) {
-      csize += cnf[pid].size();
-    }
-    for (auto nid : CN) {
-      csize += cnf[nid].size();
+    if (occ.count(p) > occurrence_limit || occ.count(n) > occurrence_limit) {
+      return false;
     }
-
-    // compute resolvents.
-    size_t rsize = 0;
-    r.clear();
-    for (auto pid : CP) {
-      for (auto nid : CN) {
-        clause_t c = resolve_ref(cnf[pid], cnf[nid], p);
-        // metrics.resolvents_tried++;
-        if (is_taut(c)) {
-          // metrics.tauts_found++;
-          continue;
+    const size_t bound = occ.count(p) + occ.count(n);
+    size_t count = 0;
+    for (clause_id pid : occ[p]) {
+      const clause_t &c = cnf[pid];
+      mark(c, p, true);
+      bool ok = true;
+      for (clause_id nid : occ[n]) {
+        size_t size = resolvent_size(c, cnf[nid], n);
+        if (size == SIZE_MAX) continue;
+        if (++count > bound || size > resolvent_limit) {
+          ok = false;
+          break;
         }
-        rsize += c.size();
-        r.push_back(std::move(c));
       }
+      mark(c, p, false);
+      if (!ok) return false;
     }
+    return true;
+  }
 
-    if (!rsize) return false;
-
-    if ((growth_factor * csize) < rsize) {
-      return false;
-    }
-
-    // export our results as needed
-    cp = CP;
-    cn = CN;
+ public:
+  size_t eliminated = 0;
 
-    return true;
+  NIVER(occurrences_t &occ) : occ(occ), cnf(occ.cnf), marks(occ.max_var) {
+    heap_index.construct(occ.max_var);
+    std::fill(std::begin(heap_index), std::end(heap_index), -1);
   }
 
-  bool any_possibility() const {
-    for (variable_t v : cnf.var_range()) {
-      if (report_possibility(v)) {
-        return true;
-      }
+  bool empty() const { return heap.empty(); }
+  void push(variable_t v) {
+    if (heap_index[v] >= 0) {
+      // Our cost may have gone either way.
+      sift_up(heap_index[v]);
+      sift_down(heap_index[v]);
+      return;
     }
-    return false;
+    heap.push_back(v);
+    sift_up(heap.size() - 1);
+  }
+  variable_t pop() {
+    variable_t v = heap[0];
+    heap_index[v] = -1;
+    variable_t last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+      heap[0] = last;
+      heap_index[last] = 0;
+      sift_down(0);
+    }
+    return v;
   }
 
-  bool try_resolve(variable_t v) {
-    // this method also initializes all the metadata
-    // we are counting on to actually resolve this
-    if (!report_possibility(v)) {
-      return false;
+  bool try_eliminate(variable_t v) {
+    literal_t p = lit(v);
+    literal_t n = neg(p);
+    if (!occ.count(p) && !occ.count(n)) return false;
+    if (!within_bounds(v)) return false;
+
+    // Adding clauses may move the arena, so we collect the resolvents first.
+    resolvents.clear();
+    neighbors.clear();
+    for (clause_id pid : occ[p]) {
+      const clause_t &c = cnf[pid];
+      mark(c, p, true);
+      for (clause_id nid : occ[n]) {
+        const clause_t &d = cnf[nid];
+        if (resolvent_size(c, d, n) == SIZE_MAX) continue;
+        std::vector<literal_t> r;
+        for (literal_t l : c) {
+          if (l != p) r.push_back(l);
+        }
+        for (literal_t l : d) {
+          if (l != n && !marks[l]) r.push_back(l);
+        }
+        std::sort(std::begin(r), std::end(r));
+        resolvents.push_back(std::move(r));
+      }
+      mark(c, p, false);
     }
 
-    for (auto pid : cp) {
-      remove_clause(pid);
-    }
-    for (auto nid : cn) {
-      remove_clause(nid);
+    // The resolvents go in first: they're derived from what we remove.
+    for (const auto &r : resolvents) {
+      occ.add_clause(r);
     }
-    for (auto &&c : r) {
-      add_clause(std::move(c));
+    for (literal_t l : {p, n}) {
+      const std::vector<clause_id> removing = occ[l];
+      for (clause_id cid : removing) {
+        for (literal_t m : cnf[cid]) {
+          if (var(m) != v) neighbors.push_back(var(m));
+        }
+        occ.eliminate_clause(cid, l);
+      }
     }
     cnf.clean_clauses();
+    eliminated++;
+
+    // Their occurrences changed, and so may have their chances.
+    for (variable_t u : neighbors) push(u);
     return true;
   }
 };
 
-bool BVE(cnf_t &cnf) {
-  NIVER niv(cnf, 1.3f);
-  bool continue_work = true;
-  bool did_work = false;
-  while (continue_work) {
-    continue_work = false;
-    // for (variable_t v : cnf.var_range()) {
-    for (auto [v, c] : niv.worklist) {
-      if (niv.try_resolve(v)) {
-        // std::cerr << "DID WORK " << v << std::endl;
-        continue_work = true;
-        did_work = true;
-      }
-    }
+size_t BVE(occurrences_t &occ, const std::vector<variable_t> &candidates) {
+  NIVER niv(occ);
+  for (variable_t v : candidates) {
+    niv.push(v);
   }
-  return did_work;
+  while (!niv.empty() && !occ.unsat) {
+    niv.try_eliminate(niv.pop());
+  }
+  return niv.eliminated;
 }
-
-bool can_BVE(cnf_t &cnf) {
-  NIVER niv(cnf, 1.0);
-  return niv.any_possibility();
-}
\ No newline at end of file
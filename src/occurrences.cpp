@@ -0,0 +1,216 @@
+#include "occurrences.h"
+
+#include <algorithm>
+
+#include "proof.h"
+
+occurrences_t::occurrences_t(cnf_t &cnf, reconstruction_t *reconstruction)
+    : cnf(cnf),
+      reconstruction(reconstruction),
+      max_var(max_variable(cnf)),
+      occurs(max_var) {
+  in_touched.construct(max_var);
+  rebuild();
+}
+
+void occurrences_t::rebuild() {
+  for (auto &cl : occurs) cl.clear();
+  units.clear();
+  dirty.clear();
+  touched.clear();
+  in_dirty.assign(cnf.arena.limit(), 0);
+  std::fill(std::begin(in_touched), std::end(in_touched), 0);
+
+  for (clause_id cid : cnf) {
+    clause_t &c = cnf[cid];
+    std::sort(std::begin(c), std::end(c));
+    for (literal_t l : c) {
+      occurs[l].push_back(cid);
+    }
+    if (c.size() == 1) units.push_back(c[0]);
+    if (c.empty()) unsat = true;
+    mark_dirty(cid);
+  }
+  for (variable_t v : variable_range(max_var)) {
+    touch(v);
+  }
+}
+
+void occurrences_t::removed_literals(
+    const std::vector<std::pair<clause_id, literal_t>> &removed) {
+  std::vector<clause_id> shrunk;
+  for (auto [cid, l] : removed) {
+    unlink(l, cid);
+    touch(var(l));
+    shrunk.push_back(cid);
+  }
+  std::sort(std::begin(shrunk), std::end(shrunk));
+  shrunk.erase(std::unique(std::begin(shrunk), std::end(shrunk)),
+               std::end(shrunk));
+  for (clause_id cid : shrunk) {
+    clause_t &c = cnf[cid];
+    std::sort(std::begin(c), std::end(c));
+    shortened(cid);
+  }
+}
+
+void occurrences_t::mark_dirty(clause_id cid) {
+  if (cid >= in_dirty.size()) in_dirty.resize(cnf.arena.limit());
+  if (in_dirty[cid]) return;
+  in_dirty[cid] = true;
+  dirty.push_back(cid);
+}
+
+void occurrences_t::touch(variable_t v) {
+  if (in_touched[v]) return;
+  in_touched[v] = true;
+  touched.push_back(v);
+}
+
+// Occurrence lists are unordered, so this is a swap-and-pop.
+void occurrences_t::unlink(literal_t l, clause_id cid) {
+  auto &cl = occurs[l];
+  auto it = std::find(std::begin(cl), std::end(cl), cid);
+  SAT_ASSERT(it != std::end(cl));
+  *it = cl.back();
+  cl.pop_back();
+}
+
+std::vector<clause_id> occurrences_t::take_dirty() {
+  std::vector<clause_id> result;
+  result.swap(dirty);
+  for (clause_id cid : result) in_dirty[cid] = false;
+  // Anything removed since it was queued is of no interest.
+  auto it = std::remove_if(std::begin(result), std::end(result),
+                           [&](clause_id cid) { return !cnf[cid].is_alive; });
+  result.erase(it, std::end(result));
+  return result;
+}
+
+std::vector<variable_t> occurrences_t::take_touched() {
+  std::vector<variable_t> result;
+  result.swap(touched);
+  for (variable_t v : result) in_touched[v] = false;
+  return result;
+}
+
+clause_id occurrences_t::add_clause(const std::vector<literal_t> &c) {
+  SAT_ASSERT(std::is_sorted(std::begin(c), std::end(c)));
+  proof::add(c);
+  clause_id cid = cnf.add_clause(c);
+  for (literal_t l : c) {
+    occurs[l].push_back(cid);
+    touch(var(l));
+  }
+  if (c.size() == 1) units.push_back(c[0]);
+  if (c.empty()) unsat = true;
+  mark_dirty(cid);
+  return cid;
+}
+
+void occurrences_t::remove_clause(clause_id cid) {
+  const clause_t &c = cnf[cid];
+  for (literal_t l : c) {
+    unlink(l, cid);
+    touch(var(l));
+  }
+  proof::del(c);
+  cnf.remove_clause(cid);
+}
+
+void occurrences_t::eliminate_clause(clause_id cid, literal_t witness) {
+  if (reconstruction) reconstruction->push(witness, cnf[cid]);
+  remove_clause(cid);
+}
+
+// Erasing in place keeps the clause sorted.
+void occurrences_t::remove_literal(clause_id cid, literal_t l) {
+  unlink(l, cid);
+  clause_t &c = cnf[cid];
+  proof::remove_literal(c, l);
+  auto it = std::remove(std::begin(c), std::end(c), l);
+  SAT_ASSERT(it == std::prev(std::end(c)));
+  (void)it;
+  c.pop_back();
+  touch(var(l));
+  shortened(cid);
+}
+
+void occurrences_t::shortened(clause_id cid) {
+  const clause_t &c = cnf[cid];
+  for (literal_t m : c) touch(var(m));
+  mark_dirty(cid);
+  if (c.size() == 1) units.push_back(c[0]);
+  if (c.empty()) unsat = true;
+}
+
+// We shrink the clauses with neg(l) first, so that (for the proof) the unit
+// justifying that is still around when we do it.
+bool occurrences_t::commit(literal_t l) {
+  auto is_unit = [&](clause_id cid) { return cnf[cid].size() == 1; };
+  // Someone else (e.g., BVE) may have already dealt with this unit's clause.
+  if (std::none_of(std::begin(occurs[l]), std::end(occurs[l]), is_unit)) {
+    return false;
+  }
+
+  // Taking the whole list saves us unlinking from it one clause at a time.
+  std::vector<clause_id> shrinking;
+  shrinking.swap(occurs[neg(l)]);
+  for (clause_id cid : shrinking) {
+    clause_t &c = cnf[cid];
+    proof::remove_literal(c, neg(l));
+    auto it = std::remove(std::begin(c), std::end(c), neg(l));
+    SAT_ASSERT(it == std::prev(std::end(c)));
+    (void)it;
+    c.pop_back();
+    shortened(cid);
+  }
+
+  // The unit itself stands in for every clause it satisfies.
+  if (reconstruction) reconstruction->push_unit(l);
+
+  std::vector<clause_id> satisfied;
+  satisfied.swap(occurs[l]);
+  for (clause_id cid : satisfied) {
+    const clause_t &c = cnf[cid];
+    for (literal_t m : c) {
+      if (m == l) continue;
+      unlink(m, cid);
+      touch(var(m));
+    }
+    proof::del(c);
+    cnf.remove_clause(cid);
+  }
+  touch(var(l));
+  return true;
+}
+
+size_t occurrences_t::propagate_units() {
+  size_t committed = 0;
+  while (!units.empty() && !unsat) {
+    literal_t l = units.back();
+    units.pop_back();
+    if (commit(l)) committed++;
+  }
+  MAX_ASSERT(validate());
+  return committed;
+}
+
+bool occurrences_t::validate() const {
+  for (clause_id cid : cnf) {
+    const clause_t &c = cnf[cid];
+    SAT_ASSERT(std::is_sorted(std::begin(c), std::end(c)));
+    for (literal_t l : c) {
+      SAT_ASSERT(contains(occurs[l], cid));
+      (void)l;
+    }
+  }
+  for (literal_t l : literal_range(max_var)) {
+    for (clause_id cid : occurs[l]) {
+      SAT_ASSERT(cnf[cid].is_alive);
+      SAT_ASSERT(contains(cnf[cid], l));
+      (void)cid;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "cnf.h"
+#include "reconstruction.h"
+
+// The preprocessor's view of the CNF: for every literal, the clauses it
+// occurs in. Every simplification (units, BCE, BVE, subsumption) adds,
+// strengthens, and removes clauses through here, so the index stays exact
+// without ever being rebuilt from scratch, and so the proof sees every step.
+//
+// We also remember what changed:
+//  - units: literals whose unit clauses we haven't committed yet.
+//  - dirty: clauses added or strengthened since the last take_dirty (each at
+//    most once). Those are the ones that might now subsume something.
+//  - touched: variables whose occurrences changed since the last
+//    take_touched. Those are the ones BCE and BVE should look at again.
+//
+// Clauses are kept sorted (by literal), which we rely on to compare them.
+//
+// Clauses we drop without them being implied (units once committed, and
+// whatever eliminate_clause is given) go on the reconstruction stack, if we
+// have one.
+struct occurrences_t {
+  cnf_t &cnf;
+  reconstruction_t *reconstruction;
+  variable_t max_var;
+  literal_map_t<std::vector<clause_id>> occurs;
+
+  std::vector<literal_t> units;
+  std::vector<clause_id> dirty;
+  std::vector<variable_t> touched;
+  // Indexed by clause_id, so it grows with the arena.
+  std::vector<uint8_t> in_dirty;
+  var_map_t<uint8_t> in_touched;
+  // Set once some clause has lost its last literal.
+  bool unsat = false;
+
+  explicit occurrences_t(cnf_t &cnf,
+                         reconstruction_t *reconstruction = nullptr);
+  // Indexes the CNF from scratch. Everything counts as dirty and touched.
+  void rebuild();
+  // For when someone else has taken literals out of clauses (and logged it),
+  // e.g. vivification, which may also have reordered what's left.
+  void removed_literals(
+      const std::vector<std::pair<clause_id, literal_t>> &removed);
+
+  const std::vector<clause_id> &operator[](literal_t l) const {
+    return occurs[l];
+  }
+  size_t count(literal_t l) const { return occurs[l].size(); }
+
+  // These log to the proof. An added clause must be sorted, without
+  // duplicate or complementary literals.
+  clause_id add_clause(const std::vector<literal_t> &c);
+  void remove_clause(clause_id cid);
+  void remove_literal(clause_id cid, literal_t l);
+  // Removes a clause that may not be implied by the rest; the witness is the
+  // literal to make true if the model leaves it false.
+  void eliminate_clause(clause_id cid, literal_t witness);
+
+  // Commit every unit we know of: strengthen the clauses with its negation,
+  // then remove those it satisfies (its unit clause among them). Returns how
+  // many we committed.
+  size_t propagate_units();
+  bool commit(literal_t l);
+
+  std::vector<clause_id> take_dirty();
+  std::vector<variable_t> take_touched();
+
+  void mark_dirty(clause_id cid);
+  void touch(variable_t v);
+  void unlink(literal_t l, clause_id cid);
+  void shortened(clause_id cid);
+  bool validate() const;
+};
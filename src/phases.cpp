@@ -0,0 +1,207 @@
+#include "phases.h"
+
+#include "settings.h"
+#include "solver.h"
+
+phases_t::phases_t(const cnf_t &cnf, trail_t &trail)
+    : trail(trail), cnf(cnf), vars(cnf.var_range()) {
+  target.construct(max_variable(cnf));
+  best.construct(max_variable(cnf));
+  std::fill(std::begin(target), std::end(target), 0);
+  std::fill(std::begin(best), std::end(best), 0);
+}
+
+void phases_t::install(solver_t &s) {
+  s.conflict_enter.add_listener([&]() { conflicts++; });
+  // This sees the trail just before we backtrack (or restart) away from it.
+  s.unassign.add_listener([&](const action_t *from) { update(from); });
+  // Rephasing wants a full restart (the reused trail would hold on to the
+  // old phases).
+  s.full_restart_wanted.push_back([&]() { return rephase_due(); });
+  s.restart.add_listener([&]() {
+    target_assigned = 0;
+    if (rephase_due()) {
+      rephase();
+    }
+  });
+  // The chooser picked the variable; we pick its polarity.
+  s.choose_literal.add_listener([&](literal_t &d) {
+    if (d) d = decide(var(d));
+  });
+}
+
+bool phases_t::rephase_due() const {
+  return settings::rephase && conflicts >= next_rephase;
+}
+
+literal_t phases_t::decide(variable_t v) const {
+  int8_t p = trail.vardata[v].phase;
+  if (settings::target_phases && target[v]) {
+    p = target[v];
+  }
+  return p < 0 ? neg(lit(v)) : lit(v);
+}
+
+// Everything below the conflict level was conflict-free (on a restart, the
+// whole trail is).
+void phases_t::update(const action_t *from) {
+  const action_t *consistent = trail.end();
+  if (trail.conflicted()) {
+    while (consistent != trail.begin() && !consistent[-1].is_decision()) {
+      consistent--;
+    }
+    if (consistent != trail.begin()) consistent--;
+  }
+  size_t n = consistent - trail.begin();
+  if (n > target_assigned) {
+    for (const action_t *a = trail.begin(); a != consistent; a++) {
+      literal_t l = a->get_literal();
+      target[var(l)] = ispos(l) ? 1 : -1;
+    }
+    target_assigned = n;
+  }
+  if (n > best_assigned) {
+    for (const action_t *a = trail.begin(); a != consistent; a++) {
+      literal_t l = a->get_literal();
+      best[var(l)] = ispos(l) ? 1 : -1;
+    }
+    best_assigned = n;
+  }
+}
+
+phases_t::rephase_t phases_t::next_policy() const {
+  static const rephase_t cycle[] = {
+      rephase_t::best,     rephase_t::walk, rephase_t::original,
+      rephase_t::best,     rephase_t::walk, rephase_t::inverted,
+      rephase_t::best,     rephase_t::random,
+  };
+  if (rephased == 0) return rephase_t::original;
+  if (rephased == 1) return rephase_t::inverted;
+  return cycle[(rephased - 2) % (sizeof(cycle) / sizeof(cycle[0]))];
+}
+
+// We're at level 0 here (a full restart, see install), so every assigned
+// variable is fixed and its saved phase doesn't matter.
+void phases_t::rephase() {
+  switch (next_policy()) {
+    case rephase_t::original:
+      for (variable_t v : vars) trail.vardata[v].phase = 1;
+      break;
+    case rephase_t::inverted:
+      for (variable_t v : vars) trail.vardata[v].phase = -1;
+      break;
+    case rephase_t::best:
+      for (variable_t v : vars) {
+        if (best[v]) trail.vardata[v].phase = best[v];
+      }
+      best_assigned = 0;
+      break;
+    case rephase_t::random:
+      for (variable_t v : vars) trail.vardata[v].phase = (rng() & 1) ? 1 : -1;
+      break;
+    case rephase_t::walk:
+      walk();
+      break;
+  }
+  // Otherwise the (old) target phases would shadow what we just did.
+  for (variable_t v : vars) target[v] = trail.vardata[v].phase;
+  target_assigned = 0;
+
+  rephased++;
+  next_rephase = conflicts + rephase_interval * (rephased + 1);
+}
+
+// A short WalkSAT over the non-learned clauses, starting from the saved
+// phases. The assignment with the fewest falsified clauses we find becomes
+// the saved phases.
+void phases_t::walk() {
+  var_map_t<int8_t> val;
+  val.construct(vars.max_var);
+  for (variable_t v : vars) {
+    if (trail.var_assigned(v)) {
+      val[v] = trail.literal_true(lit(v)) ? 1 : -1;
+    } else {
+      val[v] = trail.vardata[v].phase < 0 ? -1 : 1;
+    }
+  }
+  auto is_true = [&](literal_t l) { return (val[var(l)] > 0) == ispos(l); };
+
+  std::vector<clause_id> walked;
+  std::vector<uint32_t> true_count;
+  literal_map_t<std::vector<uint32_t>> occurrences(vars.max_var);
+  std::vector<uint32_t> unsat;
+  std::vector<uint32_t> unsat_index;
+  for (clause_id cid : cnf) {
+    const clause_t &c = cnf[cid];
+    if (c.learned || trail.clause_sat(c)) continue;
+    uint32_t i = walked.size();
+    walked.push_back(cid);
+    uint32_t count = 0;
+    for (literal_t l : c) {
+      occurrences[l].push_back(i);
+      if (is_true(l)) count++;
+    }
+    true_count.push_back(count);
+    unsat_index.push_back(unsat.size());
+    if (!count) unsat.push_back(i);
+  }
+  auto make_sat = [&](uint32_t i) {
+    uint32_t last = unsat.back();
+    unsat[unsat_index[i]] = last;
+    unsat_index[last] = unsat_index[i];
+    unsat.pop_back();
+  };
+  auto make_unsat = [&](uint32_t i) {
+    unsat_index[i] = unsat.size();
+    unsat.push_back(i);
+  };
+
+  // Flips since the best assignment so far; we undo these at the end.
+  std::vector<variable_t> since_best;
+  size_t best_unsat = unsat.size();
+  const size_t budget = 20 * walked.size();
+  std::vector<literal_t> candidates;
+  for (size_t flips = 0; flips < budget && !unsat.empty(); flips++) {
+    const clause_t &c = cnf[walked[unsat[rng() % unsat.size()]]];
+
+    // How many clauses would flipping l break (i.e., falsify)?
+    candidates.clear();
+    literal_t pick = 0;
+    size_t pick_breaks = SIZE_MAX;
+    for (literal_t l : c) {
+      if (trail.var_assigned(var(l))) continue;
+      candidates.push_back(l);
+      size_t breaks = 0;
+      for (uint32_t j : occurrences[neg(l)]) {
+        if (true_count[j] == 1) breaks++;
+      }
+      if (breaks < pick_breaks) {
+        pick = l;
+        pick_breaks = breaks;
+      }
+    }
+    if (candidates.empty()) continue;
+    if (pick_breaks > 0 && rng() % 1000 < 567) {
+      pick = candidates[rng() % candidates.size()];
+    }
+
+    variable_t v = var(pick);
+    val[v] = -val[v];
+    for (uint32_t j : occurrences[pick]) {
+      if (true_count[j]++ == 0) make_sat(j);
+    }
+    for (uint32_t j : occurrences[neg(pick)]) {
+      if (--true_count[j] == 0) make_unsat(j);
+    }
+    since_best.push_back(v);
+    if (unsat.size() < best_unsat) {
+      best_unsat = unsat.size();
+      since_best.clear();
+    }
+  }
+  for (variable_t v : since_best) val[v] = -val[v];
+
+  for (variable_t v : vars) {
+    if (!trail.var_assigned(v)) trail.vardata[v].phase = val[v];
+  }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "cnf.h"
+#include "trail.h"
+
+// Which polarity we decide on. The trail already does phase saving (each
+// variable's last value, var_data_t::phase); on top of that we keep:
+//  - target phases: the assignment of the longest conflict-free trail since
+//    the last restart. We prefer these over the saved phase.
+//  - best phases: the same, but over all time (until a rephase uses them).
+// Every so often (in conflicts) we rephase: we overwrite every saved phase by
+// the next policy in a fixed schedule (original, inverted, best, random, or
+// whatever a short local search finds).
+
+struct solver_t;
+
+struct phases_t {
+  enum class rephase_t { original, inverted, best, random, walk };
+
+  trail_t &trail;
+  const cnf_t &cnf;
+  variable_range vars;
+
+  // 1 or -1 (as with var_data_t::phase), or 0 if we have none.
+  var_map_t<int8_t> target;
+  var_map_t<int8_t> best;
+  size_t target_assigned = 0;
+  size_t best_assigned = 0;
+
+  size_t conflicts = 0;
+  size_t rephased = 0;
+  size_t rephase_interval = 1000;
+  size_t next_rephase = 1000;
+
+  std::mt19937 rng;
+
+  phases_t(const cnf_t &cnf, trail_t &trail);
+  void install(solver_t &);
+
+  literal_t decide(variable_t v) const;
+  void update(const action_t *from);
+  bool rephase_due() const;
+  rephase_t next_policy() const;
+  void rephase();
+  void walk();
+};
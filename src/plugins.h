@@ -24,13 +24,38 @@ struct plugin {
   // Passing things with nontrivial constructors/destructors
   // here is probably a bad idea.
   void operator()(Args... args) {
-    for (auto f : preconditions) {
+    for (const auto &f : preconditions) {
       f(args...);
     }
-    for (auto f : listeners) {
+    for (const auto &f : listeners) {
       f(args...);
     }
-    for (auto f : postconditions) {
+    for (const auto &f : postconditions) {
+      f(args...);
+    }
+  }
+};
+
+// A plugin whose core behavior is fixed at compile time. The Core functor is
+// called directly rather than through a std::function, so for the hot hooks
+// (every decision, every unit, every resolution step) it inlines into the
+// caller. The run-time lists still work as above, for tracing, invariant
+// checks, and optional components; they run around the core in the usual
+// pre/listener/post order.
+template <typename Core, typename... Args>
+struct fixed_plugin : plugin<Args...> {
+  Core core;
+  explicit fixed_plugin(Core core) : core(core) {}
+
+  void operator()(Args... args) {
+    for (const auto &f : this->preconditions) {
+      f(args...);
+    }
+    core(args...);
+    for (const auto &f : this->listeners) {
+      f(args...);
+    }
+    for (const auto &f : this->postconditions) {
       f(args...);
     }
   }
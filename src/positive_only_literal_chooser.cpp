@@ -13,7 +13,7 @@ positive_only_literal_chooser_t::positive_only_literal_chooser_t(
 
 literal_t positive_only_literal_chooser_t::choose() const {
   for (variable_t v : vars) {
-    if (trail.varset.get(v)) continue;
+    if (trail.var_assigned(v)) continue;
     return lit(v);
   }
   return 0;
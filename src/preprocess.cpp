@@ -2,9 +2,11 @@
 
 #include <cassert>
 #include <iostream>
-#include <map>
 
 #include "bce.h"
+#include "equivalence.h"
+#include "occurrences.h"
+#include "proof.h"
 #include "subsumption.h"
 
 #include "measurements.h"
@@ -46,116 +48,51 @@ literal_t find_pure_literal(const cnf_t &cnf) {
   return 0;
 }
 
-bool clauses_self_subsume(variable_t v, const clause_t &pclause,
-                          const clause_t &nclause) {
-  auto pit = std::begin(pclause);
-  auto nit = std::begin(nclause);
-  while (pit != std::end(pclause) && nit != std::end(nclause)) {
-    if (*pit == v) {
-      pit++;
-      continue;
-    }
-    if (*nit == neg(v)) {
-      nit++;
-      continue;
-    }
-    if (*pit != *nit) {
-      return false;
-    }
-    pit++;
-    nit++;
-  }
-  return pit == std::end(pclause) && nit == std::end(nclause);
-}
-void naive_self_subsumption(cnf_t &cnf) {
-  std::map<literal_t, std::vector<clause_id>> literal_to_clauses;
-  for (clause_id i : cnf) {
-    for (literal_t l : cnf[i]) {
-      literal_to_clauses[l].push_back(i);
-    }
-  }
-
-  for (variable_t v : cnf.var_range()) {
-    const auto &pos_clause_list = literal_to_clauses[lit(v)];
-    const auto &neg_clause_list = literal_to_clauses[neg(v)];
-    for (auto pcid : pos_clause_list) {
-      for (auto ncid : neg_clause_list) {
-        const auto &pclause = cnf[pcid];
-        const auto &nclause = cnf[ncid];
-        if (clauses_self_subsume(v, pclause, nclause)) {
-          std::cerr << "trip" << std::endl;
-        }
-      }
-    }
-  }
-}
-
-void preprocess(cnf_t &cnf) {
+void preprocess(cnf_t &cnf, reconstruction_t &reconstruction) {
   cond_log(settings::time_preprocess, solver_action::preprocessor_start,
            std::chrono::steady_clock::now());
-  // Niavely unit-prop
-  bool did_work = true;
-  // this will be useful for self-subsumption.
-  std::for_each(std::begin(cnf), std::end(cnf), [&](clause_id cid) {
-    clause_t &c = cnf[cid];
-    std::sort(std::begin(c), std::end(c));
-  });
+  // Every pass shares this index (and keeps it up to date). It also sorts
+  // our clauses, which BCE relies on.
+  occurrences_t occ(cnf, &reconstruction);
 
-  while (did_work) {
+  bool did_work = true;
+  while (did_work && !occ.unsat) {
     did_work = false;
-    did_work |= cnf::transform::apply_trivial_units(cnf) > 0;
-
-    std::vector<clause_id> bc = BCE(cnf);
-    std::sort(std::begin(bc), std::end(bc),
-              [](clause_id c1, clause_id c2) { return c2 < c1; });
-#if 0
-    std::cout << "To remove clause_ids: (should be from highest index to lowest: " << std::endl;
-    for (clause_id cid : bc) {
-      std::cout << " " << cid;
+    did_work |= occ.propagate_units() > 0;
+
+    if (settings::equivalent_literals) {
+      did_work |= substitute_equivalences(occ) > 0;
+      did_work |= occ.propagate_units() > 0;
     }
-    std::cout << std::endl;
-    std::cout << "Removing: " << bc.size() << " from " << cnf.size() << std::endl;
-    std::cout << cnf << std::endl;
-#endif
-    std::for_each(std::begin(bc), std::end(bc),
-                  [&](const clause_id cid) { cnf.remove_clause(cid); });
-
-    did_work |= cnf::transform::apply_trivial_units(cnf) > 0;
-
-    bool BVE(cnf_t & cnf);
-    if (settings::preprocess_bve && BVE(cnf)) {
-      // std::cerr << "BVE" << std::endl;
-      did_work = true;
+
+    if (settings::subsumption) {
+      did_work |= subsume(occ) > 0;
+      did_work |= occ.propagate_units() > 0;
     }
 
-    did_work |= cnf::transform::apply_trivial_units(cnf) > 0;
+    // Only what changed since the last round can be newly eliminable (or
+    // vivifiable).
+    std::vector<variable_t> touched = occ.take_touched();
 
-    bool VIV(cnf_t & cnf);
-    if (!settings::no_viv_preprocess && VIV(cnf)) {
-      // this has correctness issues?
-      did_work = true;
+    if (settings::preprocess_bce) {
+      did_work |= BCE(occ, touched) > 0;
+      did_work |= occ.propagate_units() > 0;
     }
 
-    did_work |= cnf::transform::apply_trivial_units(cnf) > 0;
+    size_t BVE(occurrences_t & occ, const std::vector<variable_t> &candidates);
+    if (settings::preprocess_bve) {
+      did_work |= BVE(occ, touched) > 0;
+    }
 
-    /*
-        std::for_each(std::begin(cnf), std::end(cnf), [&cnf](clause_id cid) {
-          std::sort(std::begin(cnf[cid]), std::end(cnf[cid]));
-        });
-
-        for (auto cid : cnf) {
-            const auto& c = cnf[cid];
-          for (auto did : cnf) {
-            const auto& d = cnf[did];
-            if (c.possibly_subsumes(d) &&
-                subsumes(c, d)) {
-                  std::cerr << "SUBSUMPTION: " << c << "; " << d << std::endl;
-            }
-          }
-        }
+    did_work |= occ.propagate_units() > 0;
+
+    size_t VIV(occurrences_t & occ, const std::vector<variable_t> &candidates);
+    if (!settings::no_viv_preprocess && !occ.unsat) {
+      // this has correctness issues?
+      did_work |= VIV(occ, touched) > 0;
+    }
 
-        naive_self_subsumption(cnf);
-        */
+    did_work |= occ.propagate_units() > 0;
 
     /*
       // THIS HAS A CORRECTNESS BUG???
@@ -171,6 +108,7 @@ void preprocess(cnf_t &cnf) {
     }
     */
   }
+  cnf.clean_clauses();
   if (settings::time_preprocess) {
     cond_log(settings::time_preprocess, solver_action::preprocessor_end,
              std::chrono::steady_clock::now());
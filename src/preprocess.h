@@ -1,3 +1,6 @@
 #include "cnf.h"
+#include "reconstruction.h"
 
-void preprocess(cnf_t &cnf);
+// What we remove that isn't implied by the rest goes on the reconstruction
+// stack, to turn the solver's model back into one of the original CNF.
+void preprocess(cnf_t &cnf, reconstruction_t &reconstruction);
@@ -0,0 +1,77 @@
+#include "proof.h"
+
+#include <cstdlib>
+
+namespace proof {
+
+writer_t *writer = nullptr;
+
+// Binary DRAT: 'a' or 'd', then each literal as a variable-length unsigned
+// 2*v + (negated), then a 0. That's exactly our literal encoding.
+void writer_t::begin(bool deletion) {
+  if (binary) {
+    put(deletion ? 'd' : 'a');
+  } else if (deletion) {
+    put('d');
+    put(' ');
+  }
+}
+
+void writer_t::literal(literal_t l) {
+  if (binary) {
+    unsigned u = l;
+    while (u > 127) {
+      put(static_cast<char>((u & 127) | 128));
+      u >>= 7;
+    }
+    put(static_cast<char>(u));
+    return;
+  }
+  int x = lit_to_dimacs(l);
+  if (x < 0) {
+    put('-');
+    x = -x;
+  }
+  char digits[16];
+  int n = 0;
+  do {
+    digits[n++] = '0' + x % 10;
+    x /= 10;
+  } while (x);
+  while (n) put(digits[--n]);
+  put(' ');
+}
+
+void writer_t::end() {
+  if (binary) {
+    put(0);
+  } else {
+    put('0');
+    put('\n');
+  }
+}
+
+void writer_t::flush() {
+  fwrite(buffer.get(), 1, used, f);
+  used = 0;
+}
+
+bool open(const char *path, bool binary) {
+  FILE *f = fopen(path, binary ? "wb" : "w");
+  if (!f) {
+    return false;
+  }
+  writer = new writer_t{f, binary};
+  std::atexit(close);
+  return true;
+}
+
+void close() {
+  if (!writer) return;
+  writer->flush();
+  fclose(writer->f);
+  delete writer;
+  writer = nullptr;
+}
+
+}  // namespace proof
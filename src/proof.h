@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+
+#include "variable.h"
+
+// DRAT proof output, for checking UNSAT answers (e.g., with drat-trim).
+// When a proof file is given, every clause we derive is logged as an addition
+// and every clause we drop as a deletion, in the order it happens. Clauses
+// strengthened in place are logged as "add the shorter copy, then delete the
+// original", so the shorter copy is always checked against a database that
+// still has the original. The original formula itself is never logged.
+namespace proof {
+
+struct writer_t {
+  // Large, so proof logging is mostly memcpy-speed appends.
+  static constexpr size_t buffer_size = 1 << 22;
+
+  FILE *f;
+  bool binary;
+  std::unique_ptr<char[]> buffer{new char[buffer_size]};
+  size_t used = 0;
+
+  void put(char c) {
+    if (used == buffer_size) flush();
+    buffer[used++] = c;
+  }
+  void begin(bool deletion);
+  void literal(literal_t l);
+  void end();
+  void flush();
+};
+
+// Null unless we're writing a proof.
+extern writer_t *writer;
+inline bool enabled() { return writer != nullptr; }
+
+// Binary DRAT unless told otherwise. The proof is flushed at exit.
+bool open(const char *path, bool binary);
+void close();
+
+template <typename C>
+void add(const C &c) {
+  if (!writer) return;
+  writer->begin(false);
+  for (literal_t l : c) writer->literal(l);
+  writer->end();
+}
+
+template <typename C>
+void del(const C &c) {
+  if (!writer) return;
+  writer->begin(true);
+  for (literal_t l : c) writer->literal(l);
+  writer->end();
+}
+
+// c is about to lose the literal r.
+template <typename C>
+void remove_literal(const C &c, literal_t r) {
+  if (!writer) return;
+  writer->begin(false);
+  for (literal_t l : c) {
+    if (l != r) writer->literal(l);
+  }
+  writer->end();
+  del(c);
+}
+
+// c is about to be cut down to its first n literals.
+template <typename C>
+void truncate(const C &c, size_t n) {
+  if (!writer) return;
+  writer->begin(false);
+  for (size_t i = 0; i < n; i++) writer->literal(c[i]);
+  writer->end();
+  del(c);
+}
+
+}  // namespace proof
@@ -0,0 +1,49 @@
+#include "reconstruction.h"
+
+#include <algorithm>
+#include <cstdio>
+
+void reconstruction_t::push(literal_t witness, const clause_t &c) {
+  SAT_ASSERT(contains(c, witness));
+  size_t begin = literals.size();
+  literals.insert(std::end(literals), std::begin(c), std::end(c));
+  entries.push_back({witness, begin, literals.size()});
+}
+
+void reconstruction_t::push_unit(literal_t l) {
+  literals.push_back(l);
+  entries.push_back({l, literals.size() - 1, literals.size()});
+}
+
+std::vector<literal_t> reconstruction_t::extend(const trail_t &trail) const {
+  literal_map_t<int8_t> value(max_var);
+  auto assign = [&](literal_t l) {
+    value[l] = 1;
+    value[neg(l)] = -1;
+  };
+  for (variable_t v : variable_range(max_var)) {
+    // The solver may not know of our last few variables at all.
+    bool known = v <= trail.value.max_var;
+    assign(known && trail.literal_true(lit(v)) ? lit(v) : neg(lit(v)));
+  }
+
+  for (auto it = entries.rbegin(); it != entries.rend(); it++) {
+    auto first = std::begin(literals) + it->begin;
+    auto last = std::begin(literals) + it->end;
+    if (std::none_of(first, last, [&](literal_t l) { return value[l] > 0; })) {
+      assign(it->witness);
+    }
+  }
+
+  std::vector<literal_t> model;
+  for (variable_t v : variable_range(max_var)) {
+    model.push_back(value[lit(v)] > 0 ? lit(v) : neg(lit(v)));
+  }
+  return model;
+}
+
+void reconstruction_t::print_certificate(const trail_t &trail) const {
+  for (literal_t l : extend(trail)) {
+    printf("%d\n", lit_to_dimacs(l));
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+
+#include "clause.h"
+#include "trail.h"
+
+// Preprocessing removes some clauses that aren't implied by what it leaves
+// behind: committed units, blocked clauses (BCE), and the clauses of
+// eliminated variables (BVE). A model of what's left needn't satisfy those, so
+// we keep each one here with its witness: a literal of the clause that we may
+// make true, if the clause ends up false, without falsifying any other clause
+// that was around when it was removed.
+//
+// That's only promised against the clauses of that moment, so we fix the model
+// up going backwards through the stack: by the time we get to a clause,
+// everything removed after it is already satisfied.
+struct reconstruction_t {
+  struct entry_t {
+    literal_t witness;
+    // The clause is literals[begin, end).
+    size_t begin;
+    size_t end;
+  };
+
+  // Of the original CNF.
+  variable_t max_var;
+  std::vector<entry_t> entries;
+  std::vector<literal_t> literals;
+
+  explicit reconstruction_t(variable_t max_var) : max_var(max_var) {}
+
+  void push(literal_t witness, const clause_t &c);
+  void push_unit(literal_t l);
+
+  // Extends the trail's assignment to a model of the original CNF, given that
+  // it satisfies what's left of it. Variables the trail doesn't assign start
+  // out false. Returns the true literal of each variable.
+  std::vector<literal_t> extend(const trail_t &trail) const;
+  void print_certificate(const trail_t &trail) const;
+};
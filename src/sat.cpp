@@ -13,7 +13,9 @@
 #include <vector>
 
 #include "cnf.h"
+#include "dimacs.h"
 #include "preprocess.h"
+#include "proof.h"
 #include "settings.h"
 #include "solver.h"
 
@@ -59,15 +61,19 @@ int main(int argc, char* argv[]) {
   // purposes, mainly)
   // NYI
 
-  // Instantiate our CNF object
-  std::string input_file;
-  char c;
-  while ((c = fgetc(stdin)) != EOF) {
-    input_file.push_back(c);
+  if (settings::proof_file &&
+      !proof::open(settings::proof_file, !settings::text_proof)) {
+    printf("Error opening proof file\n");
+    return 1;
   }
+
+  // Instantiate our CNF object
   cnf_t cnf;
+  bool from_stdin =
+      !settings::input_file || !strcmp(settings::input_file, "-");
   bool parse_successful =
-      cnf::io::load_cnf(input_file.c_str(), input_file.size(), cnf);
+      from_stdin ? cnf::io::load_cnf(stdin, cnf)
+                 : cnf::io::load_cnf_file(settings::input_file, cnf);
   if (!parse_successful) {
     printf("Error parsing input file\n");
     return 1;
@@ -79,6 +85,9 @@ int main(int argc, char* argv[]) {
     std::cout << cnf << std::endl;
   }
 
+  // Everything we might eliminate, to fix up the model with.
+  reconstruction_t reconstruction(max_variable(cnf));
+
   // Canonicalize it (remove redundancies, handle true triviliaty)
   cnf::transform::canon(cnf);
   if (settings::print_canon) {
@@ -87,7 +96,7 @@ int main(int argc, char* argv[]) {
 
   // Preprocess, if requested
   if (settings::preprocess) {
-    preprocess(cnf);
+    preprocess(cnf, reconstruction);
     if (settings::print_preprocess) {
       std::cout << cnf << std::endl;
     }
@@ -99,10 +108,14 @@ int main(int argc, char* argv[]) {
 
   // TODO(aaron): fold this into a more general case, if possible.
   if (cnf::search::immediately_unsat(cnf)) {
+    proof::add(std::vector<literal_t>());
     printf("UNSATISFIABLE\n");
     return 0;
   }
   if (cnf::search::immediately_sat(cnf)) {
+    if (settings::print_certificate) {
+      reconstruction.print_certificate(trail_t());
+    }
     printf("SATISFIABLE\n");
     return 0;
   }
@@ -113,10 +126,11 @@ int main(int argc, char* argv[]) {
 
   if (result) {
     if (settings::print_certificate) {
-      solver.trail.print_certificate();
+      reconstruction.print_certificate(solver.trail);
     }
     printf("SATISFIABLE\n");
   } else {
+    proof::add(std::vector<literal_t>());
     printf("UNSATISFIABLE\n");
   }
   return 0;
@@ -9,6 +9,9 @@ bool print_parse = false;
 bool print_canon = false;
 bool preprocess = true;
 bool print_preprocess = false;
+const char* input_file = nullptr;
+const char* proof_file = nullptr;
+bool text_proof = false;
 bool output_dimacs = true;  // this should be an enum of "output format".
 
 bool time_preprocess = false;
@@ -26,18 +29,27 @@ bool no_viv_preprocess = false;
 
 bool print_certificate = false;
 
-bool naive_vsids = true;
+bool naive_vsids = false;
+bool vmtf = false;
+bool lrb = false;
 
 bool learned_clause_minimization = true;
 bool lbd_cleaning = true;
 bool ema_restart = true;
+bool stable_mode = true;
 bool backtrack_subsumption = true;
+bool subsumption = true;
+bool equivalent_literals = true;
 bool on_the_fly_subsumption = true;
 bool trace_otf_subsumption = false;
+bool garbage_collection = true;
+bool trace_garbage_collection = false;
 
 bool only_positive_choices = false;
-bool preprocess_bve = false;
-bool preprocess_bce = false;
+bool target_phases = true;
+bool rephase = true;
+bool preprocess_bve = true;
+bool preprocess_bce = true;
 
 bool debug_max = false;  // this should ultimately be an integer or osmething.
 
@@ -70,7 +82,11 @@ std::vector<flag_t> options{
     {"trace-applications", "Trace applications", trace_applications},
     {"trace-conflicts", "Trace conflicts", trace_conflicts},
 
-    {"naive-vsids", "Use the original vsids algorithm", naive_vsids},
+    {"naive-vsids", "Use the original (linear scan) vsids algorithm",
+     naive_vsids},
+    {"vmtf", "Choose decisions by VMTF (variable move-to-front), not VSIDS",
+     vmtf},
+    {"lrb", "Choose decisions by learning rate (LRB), not VSIDS", lrb},
     {"trace-cdcl", "Emit the CDCL resolution for this clause", trace_cdcl},
     {"trace-vivification", "Trace what our viv algorithms do",
      trace_vivification},
@@ -81,12 +97,28 @@ std::vector<flag_t> options{
      learned_clause_minimization},
     {"lbd-cleaning-", "Turn off LBD", lbd_cleaning},
     {"ema-restart-", "Turn off EMA restart strategy", ema_restart},
+    {"stable-mode-",
+     "Stay in focused mode (EMA restarts), never switching to stable mode "
+     "(Luby restarts, slower VSIDS decay)",
+     stable_mode},
     {"only-positive-choices",
      "Use a naive literal-choosing strategy that can only return positive "
      "literals",
      only_positive_choices},
+    {"target-phases-",
+     "Decide on each variable's saved phase, rather than its target phase",
+     target_phases},
+    {"rephase-", "Turn off periodically resetting the saved phases", rephase},
     {"backtrack-subsumption-", "Turn off backtrack subsumption",
      backtrack_subsumption},
+    {"subsumption-",
+     "Turn off subsumption and strengthening (in the preprocessor, and of "
+     "learned clauses during search)",
+     subsumption},
+    {"equivalent-literals-",
+     "Turn off equivalent literal substitution (in the preprocessor, and "
+     "between restarts)",
+     equivalent_literals},
 
     {"preprocess-bve-", "Turn off the BVE optimization in the preprocessor",
      preprocess_bve},
@@ -97,6 +129,13 @@ std::vector<flag_t> options{
      on_the_fly_subsumption},
     {"trace-otf-subsumption", "Trace on-the-fly subsumption",
      trace_otf_subsumption},
+    {"garbage-collection-", "Turn off compaction of the clause arena",
+     garbage_collection},
+    {"text-proof", "Write the DRAT proof as text rather than binary",
+     text_proof},
+    {"trace-garbage-collection",
+     "Log the bytes reclaimed by each clause arena compaction",
+     trace_garbage_collection},
 };
 const char* trace_cdcl_clause() {
   auto flag =
@@ -131,6 +170,16 @@ int parse(int argc, char* argv[]) {
   for (int i = 1; i < argc; i++) {
     char* arg = argv[i];
     auto n = strlen(arg);
+    if (n == 1 || (n > 0 && arg[0] != '-')) {
+      if (!input_file) {
+        input_file = arg;
+      } else if (!proof_file) {
+        proof_file = arg;
+      } else {
+        return i;
+      }
+      continue;
+    }
     if (n < 2) {
       return i;  // error
     }
@@ -165,5 +214,7 @@ bool parse_strings(const std::vector<std::string>& args) {
   }
   return true;  // success
 }
-void print_help() { printf("Usage information TBD\n"); }
+void print_help() {
+  printf("Usage: sat [--flags] [file.cnf|-] [proof.drat]\n");
+}
 }  // namespace settings
\ No newline at end of file
@@ -24,6 +24,8 @@ extern bool debug_max;
 extern bool print_certificate;
 
 extern bool naive_vsids;
+extern bool vmtf;
+extern bool lrb;
 
 extern bool only_preprocess;
 extern bool no_viv_preprocess;
@@ -31,15 +33,28 @@ extern bool no_viv_preprocess;
 extern bool learned_clause_minimization;
 extern bool lbd_cleaning;
 extern bool ema_restart;
+extern bool stable_mode;
 extern bool backtrack_subsumption;
+extern bool subsumption;
+extern bool equivalent_literals;
 extern bool on_the_fly_subsumption;
 extern bool trace_otf_subsumption;
+extern bool garbage_collection;
+extern bool trace_garbage_collection;
 
 extern bool only_positive_choices;
+extern bool target_phases;
+extern bool rephase;
 
 extern bool preprocess_bve;
 extern bool preprocess_bce;
 
+// The non-flag arguments, if given: the CNF file to read (else, or if it's
+// "-", stdin), and where to write a DRAT proof.
+extern const char* input_file;
+extern const char* proof_file;
+extern bool text_proof;
+
 int parse(int argc, char* argv[]);
 bool parse_strings(const std::vector<std::string>&);
 void print_help();
@@ -9,6 +9,7 @@
 #include "lcm.h"
 #include "measurements.h"
 #include "preprocess.h"
+#include "proof.h"
 #include "subsumption.h"
 #include "viv.h"
 
@@ -49,7 +50,7 @@ bool solver_t::solve() {
       case state_t::check_units: {
         // State is either "quiescent", where
         // we ran out of units, or "conflict", we found... a conflict.
-        state = drain_unit_queue();
+        state = propagate();
 
         break;
       }
@@ -67,7 +68,7 @@ bool solver_t::solve() {
         // early out in the unsat case.
         // We do this after processing, in case if minimization is what
         // was needed to handle this.
-        if (cid == nullptr) {
+        if (cid == null_clause_id) {
           state = state_t::unsat;
           break;
         }
@@ -81,9 +82,9 @@ bool solver_t::solve() {
           break;
         }
 
-        // Do the actual backtracking, including updating the unit queue and
-        // such.
-        unit_queue.clear();
+        // Do the actual backtracking. This also pulls the propagation head
+        // back, dropping any units we had implied but not yet propagated.
+        unassign(target);
         trail.drop_from(target);
 
         // without LCM, sometimes we can learn a unit clause that is still
@@ -120,7 +121,7 @@ bool solver_t::solve() {
         // think.
         // std::cerr << "Pushing: " << lit_to_dimacs(u) << " -- " << cnf[cid]
         //<< std::endl;
-        unit_queue.push({u, cid});
+        trail.append(make_unit_prop(u, cid));
 
         state = state_t::check_units;
         break;
@@ -136,23 +137,25 @@ bool solver_t::solve() {
   }
 }
 
-solver_t::state_t solver_t::drain_unit_queue() {
-  while (!unit_queue.empty()) {
-    auto e = unit_queue.pop();
-    literal_t l = e.l;
-    clause_id c = e.c;
-    if (trail.literal_unassigned(l)) {
-      apply_unit(l, c);
-      cond_log(settings::trace_applications, solver_action::apply_unit,
-               lit_to_dimacs(l), cnf[c]);
-    } else {
-      cond_log(settings::trace_applications, solver_action::skip_unit,
-               lit_to_dimacs(l), cnf[c]);
-    }
+// Implied literals are assigned as soon as they're found, so propagation is
+// just walking the trail from the propagation head (as in MiniSat).
+solver_t::state_t solver_t::propagate() {
+  if (trail.conflicted()) {
+    return state_t::conflict;
+  }
+  while (!trail.fully_propagated()) {
+    const action_t a = trail.mem[trail.prop_head++];
+    MAX_ASSERT(a.is_unit_prop());
+    literal_t l = a.get_literal();
+    clause_id c = a.get_clause();
+    apply_unit(l, c);
+    cond_log(settings::trace_applications, solver_action::apply_unit,
+             lit_to_dimacs(l), cnf[c]);
     if (trail.conflicted()) {
       return state_t::conflict;
     }
   }
+  MAX_ASSERT(watch.validate_state());
   return state_t::quiescent;
 }
 
@@ -166,41 +169,76 @@ action_t *solver_t::determine_backtrack_level(const clause_t &c) {
 solver_t::solver_t(const cnf_t &CNF)
     : cnf(CNF),
       compact_stamped(max_variable(cnf)),
-      watch(cnf, trail, unit_queue),
-      const_watch(cnf, trail, unit_queue),
+      watch(cnf, trail),
+      const_watch(cnf, trail),
       vsids(cnf, trail),
       vsids_heap(cnf, trail),
+      vmtf(cnf, trail),
+      lrb(cnf, trail),
       polc(max_variable(cnf), trail),
-      lbd(cnf) {
+      phases(cnf, trail),
+      lbd(cnf),
+      subsumer(max_variable(cnf)),
+      equivalences(max_variable(cnf)),
+      apply_decision(core_apply_decision_t{*this}),
+      apply_unit(core_apply_unit_t{*this}),
+      cdcl_resolve(core_cdcl_resolve_t{*this}) {
   variable_t max_var = max_variable(cnf);
   trail.construct(max_var);
 
   install_core_plugins();
+  if (proof::enabled()) {
+    install_proof();
+  }
   watch.install(*this);
   // const_watch.install(*this);
 
   if (settings::lbd_cleaning) {
     install_lbd();
   }
+  if (settings::garbage_collection) {
+    install_garbage_collection();
+  }
   if (settings::ema_restart) {
     install_restart();
   }
   install_literal_chooser();
+  if (settings::subsumption) {
+    subsumer.install(*this);
+  }
+  if (settings::equivalent_literals) {
+    equivalences.install(*this);
+  }
+  // Last, so the restart policy gets the first chance to restart. If it
+  // doesn't (or there isn't one), we restart ourselves.
+  before_decision.add_listener([&](cnf_t &cnf) {
+    if (full_restart_due()) restart();
+  });
 
   remove_clause.add_listener([&](clause_id cid) { cnf.remove_clause(cid); });
 }
 
 // These are the utilities that maintain the underlying
 // CNF and trail data structures.
+// (Appending decisions and units to the trail is done by the fixed core of
+// apply_decision and apply_unit, see solver.h.)
 void solver_t::install_core_plugins() {
-  apply_decision.add_listener(
-      [&](literal_t l) { trail.append(make_decision(l)); });
-  apply_unit.add_listener([&](literal_t l, clause_id cid) {
-    trail.append(make_unit_prop(l, cid));
+  restart.add_listener([&]() {
+    action_t *target = first_decision();
+    if (!full_restart_due()) reuse_trail(target);
+    MAX_ASSERT(target == std::end(trail) || target->is_decision());
+    unassign(target);
+    trail.drop_from(target);
   });
 
-  restart.add_listener([&]() {
-    while (trail.level()) trail.pop();
+  // The trail goes first, so reasons end up in trail order.
+  relocate_clauses.add_listener([&](cnf_t &cnf) {
+    for (action_t &a : trail) {
+      if (a.has_clause()) {
+        a.c = cnf.relocate(a.c);
+      }
+    }
+    MAX_ASSERT(trail.fully_propagated());
   });
 
   remove_literal.add([&](clause_id cid, literal_t l) {
@@ -219,9 +257,10 @@ void solver_t::install_core_plugins() {
       assert(!trail_t::is_conflicted(cnf, trail));
     });
     apply_unit.pre([&](literal_t l, clause_id cid) {
-      assert(trail.count_unassigned_literals(cnf[cid]) == 1);
-      assert(trail.find_unassigned_literal(cnf[cid]) == l);
-      assert(!trail_t::is_conflicted(cnf, trail));
+      const clause_t &c = cnf[cid];
+      assert(trail.literal_true(l));
+      assert(contains(c, l));
+      assert(trail.count_false_literals(c) == c.size() - 1);
     });
     choose_literal.pre([&](literal_t l) {
 #if 0
@@ -275,13 +314,73 @@ void solver_t::install_core_plugins() {
 
 void solver_t::install_lbd() { lbd.install(*this); }
 
+// Learned clauses are logged once they're minimized. Strengthening (LCM,
+// on-the-fly subsumption) and deletion are logged before they happen, while
+// the clause still has its old literals. A clause learned by strengthening an
+// existing one in place has been logged already.
+void solver_t::install_proof() {
+  added_clause.add([&](const trail_t &trail, clause_id cid) {
+    if (!learned_in_place) proof::add(cnf[cid]);
+  });
+  remove_literal.pre(
+      [&](clause_id cid, literal_t l) { proof::remove_literal(cnf[cid], l); });
+  remove_clause.pre([&](clause_id cid) { proof::del(cnf[cid]); });
+}
+
+action_t *solver_t::first_decision() {
+  return std::find_if(std::begin(trail), std::end(trail),
+                      [](const action_t &a) { return a.is_decision(); });
+}
+
+bool solver_t::full_restart_due() const {
+  return std::any_of(std::begin(full_restart_wanted),
+                     std::end(full_restart_wanted),
+                     [](const std::function<bool()> &f) { return f(); });
+}
+
+// Removed clauses are left as holes in the arena. Once there are enough of
+// them, copy the live clauses into a fresh arena to get locality back.
+void solver_t::install_garbage_collection() {
+  before_decision.add_listener([&](cnf_t &cnf) {
+    if (cnf.arena.mostly_garbage()) {
+      size_t reclaimed = collect_garbage();
+      cond_log(settings::trace_garbage_collection,
+               solver_action::garbage_collection, reclaimed);
+    }
+  });
+}
+
+size_t solver_t::collect_garbage() {
+  cnf.begin_compaction();
+  relocate_clauses(cnf);
+  return cnf.end_compaction();
+}
+
 void solver_t::install_restart() {
-  restart.add_listener([&]() { ema_restart.reset(); });
+  restart.add_listener([&]() {
+    ema_restart.reset();
+    if (mode == mode_t::stable) luby_restart.next();
+  });
   before_decision.add_listener([&](const cnf_t &cnf) {
-    if (ema_restart.should_restart()) {
+    if (settings::stable_mode && mode_conflicts >= mode_length) {
       restart();
+      switch_mode();
+      return;
+    }
+    switch (mode) {
+      case mode_t::focused:
+        if (ema_restart.should_restart()) restart();
+        break;
+      case mode_t::stable:
+        if (luby_restart.should_restart()) restart();
+        break;
     }
   });
+  conflict_enter.add_listener([&]() {
+    mode_conflicts++;
+    luby_restart.step();
+    ema_restart.block(trail.next_index);
+  });
   added_clause.add_listener([&](const trail_t &trail, clause_id cid) {
     // this is frustrating: we read into the lbd cache, nothing to do with our
     // parameters.
@@ -290,6 +389,14 @@ void solver_t::install_restart() {
   });
 }
 
+void solver_t::switch_mode() {
+  mode = mode == mode_t::focused ? mode_t::stable : mode_t::focused;
+  mode_conflicts = 0;
+  mode_length *= 2;
+  vsids_heap.alpha = mode == mode_t::stable ? stable_decay : focused_decay;
+  luby_restart.reset();
+}
+
 void solver_t::install_literal_chooser() {
   if (settings::only_positive_choices) {
     choose_literal.add_listener([&](literal_t &d) { d = polc.choose(); });
@@ -302,13 +409,86 @@ void solver_t::install_literal_chooser() {
 
     choose_literal.add_listener([&](literal_t &d) { d = vsids.choose(); });
     restart.add_listener([&]() { vsids.static_activity(); });
+    phases.install(*this);
+  } else if (settings::lrb) {
+    apply_decision.add_listener([&](literal_t l) { lrb.assigned(var(l)); });
+    apply_unit.add_listener(
+        [&](literal_t l, clause_id cid) { lrb.assigned(var(l)); });
+    conflict_enter.add([&]() {
+      lrb.conflict(cnf[trail.rbegin()->get_clause()]);
+    });
+    cdcl_resolve.add(
+        [&](literal_t l, clause_id cid) { lrb.resolved(l, cnf[cid]); });
+    added_clause.add([&](const trail_t &trail, clause_id cid) {
+      lrb.clause_learned(cnf[cid]);
+    });
+    // Everything before the propagation head went through apply_*.
+    unassign.add([&](const action_t *from) {
+      const action_t *head = std::begin(trail) + trail.prop_head;
+      for (const action_t *a = from; a != std::end(trail); a++) {
+        if (a->has_literal()) lrb.unassigned(var(a->get_literal()), a < head);
+      }
+    });
+
+    choose_literal.add_listener([&](literal_t &d) { d = lrb.choose(); });
+    reuse_trail.add_listener([&](action_t *&target) {
+      variable_t next = lrb.heap.peek();
+      for (; target != std::end(trail); target++) {
+        if (!target->is_decision()) continue;
+        if (next && !lrb.heap.before(var(target->get_literal()), next)) {
+          break;
+        }
+      }
+    });
+    phases.install(*this);
+  } else if (settings::vmtf) {
+    added_clause.add([&](const trail_t &trail, clause_id cid) {
+      vmtf.clause_learned(cnf[cid]);
+    });
+    cdcl_resolve.add(
+        [&](literal_t l, clause_id cid) { vmtf.bump_variable(var(l)); });
+    unassign.add([&](const action_t *from) {
+      for (const action_t *a = from; a != std::end(trail); a++) {
+        if (a->has_literal()) vmtf.unassigned(var(a->get_literal()));
+      }
+    });
+
+    choose_literal.add_listener([&](literal_t &d) { d = vmtf.choose(); });
+    // As with VSIDS, but "more active" is "more recently bumped".
+    reuse_trail.add_listener([&](action_t *&target) {
+      variable_t next = vmtf.peek();
+      for (; target != std::end(trail); target++) {
+        if (!target->is_decision()) continue;
+        if (next && !vmtf.before(var(target->get_literal()), next)) {
+          break;
+        }
+      }
+    });
+    phases.install(*this);
   } else {
     added_clause.add([&](const trail_t &trail, clause_id cid) {
-      vsids.clause_learned(cnf[cid]);
+      vsids_heap.clause_learned(cnf[cid]);
+    });
+    cdcl_resolve.core.bump_vsids = true;
+    unassign.add([&](const action_t *from) {
+      for (const action_t *a = from; a != std::end(trail); a++) {
+        if (a->has_literal()) vsids_heap.unassigned(var(a->get_literal()));
+      }
     });
 
     choose_literal.add_listener([&](literal_t &d) { d = vsids_heap.choose(); });
-    restart.add_listener([&]() { vsids_heap.static_activity(); });
+    // Keep every level whose decision is still more active than what we'd
+    // decide next.
+    reuse_trail.add_listener([&](action_t *&target) {
+      variable_t next = vsids_heap.peek();
+      for (; target != std::end(trail); target++) {
+        if (!target->is_decision()) continue;
+        if (next && !vsids_heap.before(var(target->get_literal()), next)) {
+          break;
+        }
+      }
+    });
+    phases.install(*this);
   }
 }
 
@@ -403,9 +583,10 @@ clause_id solver_t::determine_conflict_clause() {
     }
   }
 
-  clause_id to_return = nullptr;
+  clause_id to_return = null_clause_id;
   bool to_lbd = true;
-  if (last_subsumed == std::prev(it)) {
+  learned_in_place = last_subsumed == std::prev(it);
+  if (learned_in_place) {
     to_return = last_subsumed->get_clause();
     // hack: will be re-added with "added clause"
     watch.remove_clause(to_return);
@@ -415,8 +596,7 @@ clause_id solver_t::determine_conflict_clause() {
     MAX_ASSERT(it->has_literal());
     MAX_ASSERT(counter == 1);
 
-    clause_t learned_clause{compact_stamped};
-    to_return = cnf.add_clause(std::move(learned_clause));
+    to_return = cnf.add_clause(compact_stamped);
   }
   // Having learned the clause, now minimize it.
   // Fun fact: there are some rare cases where we're able to minimize the
@@ -424,12 +604,22 @@ clause_id solver_t::determine_conflict_clause() {
   // This doesn't really give us a perf benefit in my motivating benchmarks,
   // though.
   if (settings::learned_clause_minimization) {
+    // A clause strengthened in place is already in the proof, so minimizing
+    // it is one more strengthening.
+    std::vector<literal_t> logged;
+    if (learned_in_place && proof::enabled()) {
+      logged.assign(std::begin(cnf[to_return]), std::end(cnf[to_return]));
+    }
     learned_clause_minimization(cnf, cnf[to_return], trail);
+    if (logged.size() > cnf[to_return].size()) {
+      proof::add(cnf[to_return]);
+      proof::del(logged);
+    }
   }
 
   // Special, but crucial, case.
   if (cnf[to_return].size() == 0) {
-    return nullptr;
+    return null_clause_id;
   }
 
 #if 0
@@ -486,8 +676,9 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size) {
   // Just exercise the parser.
   return 0;
 
+  reconstruction_t reconstruction(max_variable(cnf));
   cnf::transform::canon(cnf);
-  preprocess(cnf);
+  preprocess(cnf, reconstruction);
   if (cnf::search::immediately_unsat(cnf)) {
     return 0;
   }
@@ -1,13 +1,41 @@
 #pragma once
 #include "cnf.h"
 #include "ema.h"
+#include "equivalence.h"
 #include "lbd.h"
+#include "lrb.h"
+#include "luby.h"
+#include "phases.h"
 #include "plugins.h"
 #include "positive_only_literal_chooser.h"
-#include "unit_queue.h"
+#include "subsumption.h"
+#include "vmtf.h"
 #include "vsids.h"
 #include "watched_literals.h"
 
+struct solver_t;
+
+// The core of apply_decision and apply_unit: let the watched literals find
+// what the newly-true literal implies. These are the hottest hooks we have, so
+// they're composed at compile time (see fixed_plugin).
+struct core_apply_decision_t {
+  solver_t &s;
+  void operator()(literal_t l);
+};
+struct core_apply_unit_t {
+  solver_t &s;
+  void operator()(literal_t l, clause_id cid);
+};
+// The core of cdcl_resolve, called for every clause conflict analysis
+// resolves with: what the default configuration does there. Installing the
+// default chooser (the heap VSIDS) and LBD cleaning turns their parts on.
+struct core_cdcl_resolve_t {
+  solver_t &s;
+  bool bump_vsids = false;
+  bool mark_used = false;
+  void operator()(literal_t l, clause_id cid);
+};
+
 struct solver_t {
   // The root data structure, the "true" CNF.
   // Currently we'll add learned clauses directly to this.
@@ -28,22 +56,42 @@ struct solver_t {
   watched_literals_t watch;
   const_watched_literals_t const_watch;
 
-  // This is our queue of "pending" units that we need to prop.
-  // We separate this rather than put things on the trail directly
-  // originally to keep things simple. I wonder if we can adjust our
-  // model so that this is unecessary.
-  unit_queue_t unit_queue;
-
   // This VSIDS object is how we choose our literals.
   vsids_t vsids;
   vsids_heap_t vsids_heap;
+  vmtf_t vmtf;
+  lrb_t lrb;
   positive_only_literal_chooser_t polc;
+  // ...and this picks their polarity.
+  phases_t phases;
 
   // Our main clause-removal heuristic:
   lbd_t lbd;
+  // ...and every so often, we drop (or shrink) learned clauses that others
+  // subsume.
+  subsumer_t subsumer;
+  // ...and substitute equivalent literals.
+  equivalences_t equivalences;
 
   // Our main restart heuristic
   ema_restart_t ema_restart;
+  // ...and the one we use in stable mode.
+  luby_restart_t luby_restart;
+
+  // We alternate between two modes of search: focused (EMA restarts, fast
+  // VSIDS decay) and stable (Luby restarts, slow decay), each time staying
+  // twice as long as last time. Mostly, focused is good for UNSAT, and stable
+  // for SAT.
+  enum class mode_t { focused, stable };
+  mode_t mode = mode_t::focused;
+  size_t mode_conflicts = 0;
+  size_t mode_length = 1000;
+  const double focused_decay = 0.95;
+  const double stable_decay = 0.975;
+
+  // Whether the clause we just learned is an existing one that on-the-fly
+  // subsumption strengthened, rather than a new one.
+  bool learned_in_place = false;
 
   // We model our solver as a state machine.
   // These are the fundamental states it can be in:
@@ -59,16 +107,32 @@ struct solver_t {
   // "different" optimizations, and how much of it is one big soup?
   plugin<cnf_t &> before_decision;
   plugin<literal_t &> choose_literal;
-  plugin<literal_t> apply_decision;
-  plugin<literal_t, clause_id> apply_unit;
+  fixed_plugin<core_apply_decision_t, literal_t> apply_decision;
+  fixed_plugin<core_apply_unit_t, literal_t, clause_id> apply_unit;
   plugin<> conflict_enter;
   plugin<const trail_t &, clause_id> added_clause;
   plugin<clause_id, literal_t> remove_literal;
   plugin<> restart;
+  // A restart drops the trail from the given action (at first, the first
+  // decision) on. Listeners may move that later, to keep the decisions we'd
+  // just make again anyway ("trail reuse"). It must stay a decision, or the
+  // end of the trail.
+  plugin<action_t *&> reuse_trail;
+  // Some work (inprocessing, rephasing) is done on restart, and wants to find
+  // us at level 0. While any of these says so, the next restart is a full one
+  // (no trail reuse), and we don't wait for the restart policy to get there.
+  std::vector<std::function<bool()>> full_restart_wanted;
   plugin<> start_solve;
   plugin<> end_solve;
-  plugin<literal_t, clause_id> cdcl_resolve;
+  fixed_plugin<core_cdcl_resolve_t, literal_t, clause_id> cdcl_resolve;
   plugin<clause_id> remove_clause;
+  // Everything from this action to the end of the trail is about to be
+  // dropped (backtracking, restarts); it's all still on the trail.
+  plugin<const action_t *> unassign;
+  // Everything holding a clause_id must rewrite it with cnf.relocate(cid).
+  // Listeners run in install order, which is the order clauses get laid out
+  // in the compacted arena.
+  plugin<cnf_t &> relocate_clauses;
 
   // These install the fundamental actions.
   void install_core_plugins();
@@ -76,13 +140,37 @@ struct solver_t {
   void install_lbd();
   void install_restart();
   void install_literal_chooser();
+  void install_garbage_collection();
+  void install_proof();
 
   // We create a local copy of the CNF.
   solver_t(const cnf_t &cnf);
   // These are the core methods. Solve is the only real entry point,
   // the others are key helper methods.
   bool solve();
-  state_t drain_unit_queue();
+  state_t propagate();
   clause_id determine_conflict_clause();
   action_t *determine_backtrack_level(const clause_t &c);
+  size_t collect_garbage();
+  void switch_mode();
+  action_t *first_decision();
+  bool full_restart_due() const;
 };
+
+// We only decide when everything is propagated, so the decision is the head.
+inline void core_apply_decision_t::operator()(literal_t l) {
+  MAX_ASSERT(s.trail.fully_propagated());
+  s.trail.append(make_decision(l));
+  s.trail.prop_head = s.trail.next_index;
+  s.watch.literal_falsed(l);
+}
+
+// Units are already on the trail; this is called as the head passes them.
+inline void core_apply_unit_t::operator()(literal_t l, clause_id cid) {
+  s.watch.literal_falsed(l);
+}
+
+inline void core_cdcl_resolve_t::operator()(literal_t l, clause_id cid) {
+  if (bump_vsids) s.vsids_heap.bump_variable(var(l));
+  if (mark_used) s.lbd.clause_used(cid, s.trail);
+}
@@ -1,11 +1,10 @@
+#include "subsumption.h"
+
 #include <algorithm>
 #include <iterator>
-#include <memory>
 #include <vector>
 
-#include "cnf.h"
-
-std::unique_ptr<literal_map_t<clause_set_t>> literal_to_clause;
+#include "solver.h"
 
 bool subsumes_and_sort(const clause_t &c, const clause_t &d) {
   // Keep the memory pool as large as needed.
@@ -43,84 +42,162 @@ bool subsumes(const clause_t &c, const clause_t &d) {
   return std::includes(std::begin(d), std::end(d), std::begin(c), std::end(c));
 }
 
-std::vector<clause_id> find_subsumed(cnf_t &cnf, const clause_t &c) {
-  // Find the literal with the shortest occur list.
-  auto compare_incidence_list = [&](literal_t a, literal_t b) {
-    return (*literal_to_clause)[a].size() < (*literal_to_clause)[b].size();
-  };
-  literal_t l =
-      *std::min_element(std::begin(c), std::end(c), compare_incidence_list);
-
-  const auto &cids = (*literal_to_clause)[l];
+subsumer_t::subsumer_t(variable_t max_var)
+    : watches(max_var), occurrences(max_var), marks(max_var) {}
 
-  // Find everything in that occur list that we subsume.
-  std::vector<clause_id> result;
-  auto result_insert = std::back_inserter(result);
-  std::copy_if(std::begin(cids), std::end(cids), result_insert,
-               [&](clause_id cid) { return subsumes(c, cnf[cid]); });
-
-  return result;
+uint64_t subsumer_t::signature(const clause_t &c) {
+  uint64_t sig = 0;
+  for (literal_t l : c) {
+    sig |= uint64_t(1) << (l & 63);
+  }
+  return sig;
 }
 
-std::vector<clause_id> self_subsume(cnf_t &cnf, clause_id cid) {
-  // deliberately *copying* here.
-  std::vector<clause_id> strengthened;
-  std::vector<literal_t> c;
-  for (literal_t l : cnf[cid]) {
-    c.push_back(l);
+size_t subsumer_t::run(cnf_t &cnf, std::vector<clause_id> candidates) {
+  size_t before = subsumed + strengthened;
+
+  std::sort(std::begin(candidates), std::end(candidates),
+            [&](clause_id a, clause_id b) {
+              size_t as = cnf[a].size(), bs = cnf[b].size();
+              return as < bs || (as == bs && a < b);
+            });
+  for (clause_id cid : candidates) {
+    for (literal_t l : cnf[cid]) occurrences[l]++;
   }
-  for (size_t i = 0; i < c.size(); i++) {
-    c[i] = neg(c[i]);
-    std::sort(std::begin(c), std::end(c));
-    auto subsumes = find_subsumed(cnf, c);
-    for (auto did : subsumes) {
-      clause_t &d = cnf[did];
-      // std::cerr << "[SUB] Shrinking " << d << " -> ";
-      auto dit = std::remove(std::begin(d), std::end(d), c[i]);
-      SAT_ASSERT(dit != std::end(d));
-      auto to_erase = std::distance(dit, std::end(d));
-      for (auto i = 0; i < to_erase; i++) {
-        d.pop_back();
+
+  std::vector<literal_t> lits;
+  for (clause_id cid : candidates) {
+    clause_t &c = cnf[cid];
+    bool c_fresh = fresh(cid);
+
+    bool removed = false;
+    if (may_change(cid)) {
+      lits.assign(std::begin(c), std::end(c));
+      // A watched clause can only help us if all its literals are in c, or
+      // all but one whose negation is.
+      uint64_t sig = 0;
+      for (literal_t l : lits) {
+        marks[l] = true;
+        sig |= (uint64_t(1) << (l & 63)) | (uint64_t(1) << (neg(l) & 63));
+      }
+
+      for (literal_t l : lits) {
+        for (literal_t k : {l, neg(l)}) {
+          for (const watch_t &w : watches[k]) {
+            if (!c_fresh && !w.fresh) continue;
+            if (w.size > c.size() || (w.signature & ~sig)) continue;
+
+            literal_t flipped = 0;
+            bool fits = true;
+            for (literal_t x : cnf[w.cid]) {
+              if (marks[x]) continue;
+              if (!flipped && marks[neg(x)]) {
+                flipped = x;
+                continue;
+              }
+              fits = false;
+              break;
+            }
+            if (!fits) continue;
+
+            if (!flipped) {
+              remove(cid, w.cid);
+              subsumed++;
+              removed = true;
+              break;
+            }
+            // w is (part of c) or neg(m), for some m in c: resolving the two
+            // on m gives us c without m.
+            literal_t m = neg(flipped);
+            if (c.size() > 1 && strengthen(cid, m)) {
+              marks[m] = false;
+              strengthened++;
+            }
+          }
+          if (removed) break;
+        }
+        if (removed) break;
       }
-      // d.erase(dit, std::end(d));
-      // std::cerr << d << std::endl;
-      strengthened.push_back(did);
+      for (literal_t l : lits) marks[l] = false;
     }
-    c[i] = neg(c[i]);
-    std::sort(std::begin(c), std::end(c));
+    if (removed || c.empty()) continue;
+
+    literal_t best = *std::min_element(
+        std::begin(c), std::end(c), [&](literal_t a, literal_t b) {
+          return occurrences[a] < occurrences[b];
+        });
+    watches[best].push_back({cid, uint32_t(c.size()), signature(c), c_fresh});
   }
-  return strengthened;
+
+  for (auto &ws : watches) ws.clear();
+  std::fill(std::begin(occurrences), std::end(occurrences), 0);
+  return subsumed + strengthened - before;
+}
+
+// We only check pairs where one of the clauses is dirty: the rest we've
+// already checked (or never changed since the CNF was loaded, but then
+// the first round has everything dirty).
+size_t subsume(occurrences_t &occ) {
+  cnf_t &cnf = occ.cnf;
+  std::vector<clause_id> dirty = occ.take_dirty();
+  if (dirty.empty()) return 0;
+  std::vector<uint8_t> is_dirty(cnf.arena.limit(), false);
+  for (clause_id cid : dirty) is_dirty[cid] = true;
+
+  subsumer_t sub(occ.max_var);
+  sub.fresh = [&](clause_id cid) { return is_dirty[cid]; };
+  sub.may_change = [](clause_id cid) { return true; };
+  sub.remove = [&](clause_id cid, clause_id by) { occ.remove_clause(cid); };
+  sub.strengthen = [&](clause_id cid, literal_t l) {
+    occ.remove_literal(cid, l);
+    return true;
+  };
+  return sub.run(cnf, {std::begin(cnf), std::end(cnf)});
 }
 
-size_t naive_self_subsume(cnf_t &cnf) {
-  std::for_each(std::begin(cnf), std::end(cnf), [&](clause_id cid) {
-    std::sort(std::begin(cnf[cid]), std::end(cnf[cid]));
+void subsumer_t::install(solver_t &s) {
+  s.conflict_enter.add_listener([&]() { conflicts++; });
+  // At level 0, everything assigned is fixed, so we can't upset the trail
+  // (or the watches) by changing clauses that aren't reasons.
+  s.full_restart_wanted.push_back([&]() { return due(); });
+  s.restart.add_listener([&]() {
+    if (due()) run_learned(s);
   });
+}
 
-  literal_to_clause =
-      std::make_unique<literal_map_t<clause_set_t>>(max_variable(cnf));
-  for (clause_id cid : cnf) {
+// Any clause can subsume (or strengthen), but only learned ones are changed:
+// an original clause subsumed by a learned one would have to take over its
+// place. A clause subsuming a learned one inherits its tier, if that's better.
+void subsumer_t::run_learned(solver_t &s) {
+  cnf_t &cnf = s.cnf;
+  const trail_t &trail = s.trail;
+  MAX_ASSERT(trail.level() == 0);
+
+  fresh = [&](clause_id cid) { return cnf[cid].learned; };
+  may_change = [&](clause_id cid) {
     const clause_t &c = cnf[cid];
-    for (literal_t l : c) {
-      (*literal_to_clause)[l].push_back(cid);
-    }
-  }
+    return c.learned && !trail.is_reason(cid, c);
+  };
+  remove = [&](clause_id cid, clause_id by) {
+    clause_t &b = cnf[by];
+    if (b.learned && cnf[cid].tier < b.tier) b.tier = cnf[cid].tier;
+    s.lbd.remove(cid);
+    s.remove_clause(cid);
+  };
+  // The clause must keep two unassigned literals to watch.
+  strengthen = [&](clause_id cid, literal_t l) {
+    if (!trail.literal_unassigned(l)) return false;
+    if (trail.count_unassigned_literals(cnf[cid]) < 3) return false;
+    s.remove_literal(cid, l);
+    return true;
+  };
 
-  bool did_work = true;
-  size_t total_strengthened = 0;
-  while (did_work) {
-    did_work = false;
-    for (auto cid : cnf) {
-      auto res = self_subsume(cnf, cid);
-      if (res.size() > 0) {
-        std::cerr << "tripped" << std::endl;
-        did_work = true;
-        total_strengthened += res.size();
-      }
-    }
+  std::vector<clause_id> candidates;
+  for (clause_id cid : cnf) {
+    if (cnf[cid].size() <= size_limit) candidates.push_back(cid);
   }
+  run(cnf, candidates);
+  cnf.clean_clauses();
 
-  literal_to_clause.release();
-
-  return total_strengthened;
-}
\ No newline at end of file
+  next_run = conflicts + run_interval;
+}
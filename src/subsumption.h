@@ -1,6 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <functional>
 #include <vector>
 
-#include "cnf.h"
-std::vector<clause_id> find_subsumed(cnf_t &cnf, const clause_t &c);
+#include "occurrences.h"
+#include "trail.h"
+
 bool subsumes(const clause_t &c, const clause_t &d);
 bool subsumes_and_sort(const clause_t &c, const clause_t &d);
+
+struct solver_t;
+
+// Backward subsumption and self-subsuming strengthening. We go through the
+// candidates by increasing size, so anything that could subsume (or
+// strengthen) a clause has been seen before it. Each clause we've seen is
+// watched by just one of its literals, the one occurring least often among
+// the candidates, so checking a clause C means walking the lists of C's
+// literals and their negations. A 64-bit literal signature per watch rules out
+// most of those without touching the clause.
+//
+// The same pass serves the preprocessor (over the whole CNF, through the
+// occurrence index) and the solver, which every so often (at a full restart)
+// runs it over the learned clauses.
+struct subsumer_t {
+  // Pairs where neither clause is fresh were looked at by an earlier pass.
+  std::function<bool(clause_id)> fresh;
+  // Whether we may remove (or strengthen) this clause at all.
+  std::function<bool(clause_id)> may_change;
+  // The first clause is subsumed by the second.
+  std::function<void(clause_id, clause_id)> remove;
+  // Drop the literal from the clause, if that's allowed.
+  std::function<bool(clause_id, literal_t)> strengthen;
+
+  struct watch_t {
+    clause_id cid;
+    uint32_t size;
+    uint64_t signature;
+    bool fresh;
+  };
+  literal_map_t<std::vector<watch_t>> watches;
+  literal_map_t<uint32_t> occurrences;
+  literal_map_t<uint8_t> marks;
+
+  size_t subsumed = 0;
+  size_t strengthened = 0;
+
+  explicit subsumer_t(variable_t max_var);
+  static uint64_t signature(const clause_t &c);
+  // Returns how many clauses we removed or strengthened.
+  size_t run(cnf_t &cnf, std::vector<clause_id> candidates);
+
+  // For inprocessing: counted in conflicts.
+  size_t conflicts = 0;
+  size_t next_run = 2000;
+  size_t run_interval = 2000;
+  // Longer clauses are neither worth the time nor likely to subsume much.
+  static constexpr size_t size_limit = 100;
+
+  void install(solver_t &s);
+  bool due() const { return conflicts >= next_run; }
+  void run_learned(solver_t &s);
+};
+
+// Subsume and strengthen with (at least one of) the clauses added or
+// strengthened since the last time. Returns how many clauses changed.
+size_t subsume(occurrences_t &occ);
@@ -2,56 +2,24 @@
 
 #include <iostream>
 
-struct new_trail_t {
-  size_t level;
-  size_t size;
-  std::vector<action_t> mem;
-  std::vector<var_data_t> data;
-  void construct(size_t max_var);
-};
-
-void new_trail_t::construct(size_t max_var) {
-  level = 0;
-  size = max_var + 1;
-
-  mem.resize(size);
-  data.resize(size);
-}
-
 void trail_t::construct(size_t max_var) {
   size = max_var + 1;
   next_index = 0;
   dlevel = 0;
+  prop_head = 0;
 
-  litstate.construct(max_var);
-  oldlitstate.construct(max_var);
-  varset.construct(max_var);
-  varlevel.construct(max_var);
-  lit_to_action.construct(max_var);
+  value.construct(max_var);
+  vardata.construct(max_var);
 
   mem.resize(size);
 
-  varset.clear();
-  std::fill(std::begin(litstate), std::end(litstate), v_state_t::unassigned);
-  std::fill(std::begin(oldlitstate), std::end(oldlitstate),
-            v_state_t::unassigned);
-}
-
-bool trail_t::literal_true(const literal_t l) const {
-  return litstate[l] == v_state_t::var_true;
-}
-bool trail_t::literal_false(const literal_t l) const {
-  return litstate[l] == v_state_t::var_false;
-}
-
-bool trail_t::literal_unassigned(const literal_t l) const {
-  return litstate[l] == v_state_t::unassigned;
+  std::fill(std::begin(value), std::end(value), 0);
+  std::fill(std::begin(vardata), std::end(vardata), var_data_t{});
 }
 
 action_t trail_t::cause(literal_t l) const {
   SAT_ASSERT(literal_true(l));
-  SAT_ASSERT(varset.get(var(l)));
-  return *lit_to_action[l];
+  return mem[vardata[var(l)].reason];
 }
 
 void trail_t::append(action_t a) {
@@ -62,20 +30,18 @@ void trail_t::append(action_t a) {
   }
   if (a.has_literal()) {
     literal_t l = a.get_literal();
-    variable_t v = var(l);
-    if (varset.get(v)) {
+    if (value[l]) {
       // Don't add!
       return;
     }
-    varset.set(v);
-    varlevel[v] = dlevel;
-    litstate[l] = v_state_t::var_true;
-    litstate[neg(l)] = v_state_t::var_false;
-    oldlitstate[l] = v_state_t::var_true;
-    oldlitstate[neg(l)] = v_state_t::var_false;
+    value[l] = 1;
+    value[neg(l)] = -1;
 
-    // We never bother cleaning this. Mistake?
-    lit_to_action[l] = &mem[next_index];
+    // We never bother cleaning this (phase in particular must survive).
+    var_data_t &d = vardata[var(l)];
+    d.level = dlevel;
+    d.reason = next_index;
+    d.phase = ispos(l) ? 1 : -1;
   }
   // if (next_index == size) {
   // std::cout << "[DBG][ERR] No room for " << a << " in trail" << std::endl;
@@ -90,12 +56,7 @@ void trail_t::append(action_t a) {
 
 literal_t trail_t::previously_assigned_literal(variable_t v) const {
   literal_t l = lit(v);
-  switch (oldlitstate[l]) {
-    case v_state_t::var_false:
-      return neg(l);
-    default:
-      return l;
-  }
+  return vardata[v].phase < 0 ? neg(l) : l;
 }
 
 action_t trail_t::pop() {
@@ -104,15 +65,16 @@ action_t trail_t::pop() {
   action_t a = mem[next_index];
   if (a.has_literal()) {
     literal_t l = a.get_literal();
-    variable_t v = var(l);
-    varset.clear(v);
-    litstate[l] = v_state_t::unassigned;
-    litstate[neg(l)] = v_state_t::unassigned;
-    // we deliberately *don't* erase the oldlitstate.
+    value[l] = 0;
+    value[neg(l)] = 0;
+    // we deliberately *don't* erase the vardata (i.e., the saved phase).
   }
   if (a.is_decision()) {
     dlevel--;
   }
+  if (prop_head > next_index) {
+    prop_head = next_index;
+  }
   return a;
 }
 
@@ -143,30 +105,6 @@ literal_t trail_t::find_unassigned_literal(const clause_t &c) const {
   });
 }
 
-std::ostream &operator<<(std::ostream &o, const trail_t::v_state_t s) {
-  switch (s) {
-    case trail_t::v_state_t::unassigned:
-      return o << "unassigned";
-    case trail_t::v_state_t::var_true:
-      return o << "true";
-    case trail_t::v_state_t::var_false:
-      return o << "false";
-  };
-  return o;
-}
-
-std::ostream &operator<<(std::ostream &o,
-                         const std::vector<trail_t::v_state_t> &s) {
-  o << "{ ";
-  for (size_t i = 0; i < s.size(); i++) {
-    auto v = s[i];
-    if (v != trail_t::v_state_t::unassigned) {
-      o << i << "=" << v << " ";
-    }
-  }
-  return o << "}";
-}
-
 std::ostream &operator<<(std::ostream &o, const trail_t &t) {
   for (auto a : t) {
     o << '\t' << a << std::endl;
@@ -193,6 +131,20 @@ bool trail_t::uses_clause(const clause_id cid) const {
   return false;
 }
 
+// The same question as uses_clause (minus conflicts), but without the trail
+// scan: if c is a reason, it's the reason of one of its own true literals, and
+// we record every literal's reason.
+bool trail_t::is_reason(const clause_id cid, const clause_t &c) const {
+  for (literal_t l : c) {
+    if (!literal_true(l)) continue;
+    const action_t &a = mem[vardata[var(l)].reason];
+    if (a.is_unit_prop() && a.get_clause() == cid) {
+      return true;
+    }
+  }
+  return false;
+}
+
 size_t trail_t::level(action_t a) const {
   size_t l = 0;
   for (action_t b : *this) {
@@ -204,7 +156,7 @@ size_t trail_t::level(action_t a) const {
   assert(0);
   return 0;
 }
-size_t trail_t::level(literal_t l) const { return varlevel[var(l)]; }
+size_t trail_t::level(literal_t l) const { return vardata[var(l)].level; }
 
 void trail_t::drop_from(action_t *it) {
   // std::cout << it << " " << &(mem[next_index]) << std::endl;
@@ -312,12 +264,6 @@ void trail_t::validate(const cnf_t &cnf, const trail_t &trail) {
   T.validate_trail(trail);
 }
 
-void trail_t::print_certificate() const {
-  for (auto &a : *this) {
-    printf("%d\n", lit_to_dimacs(a.get_literal()));
-  }
-}
-
 bool trail_t::has_unit(const cnf_t &cnf, const trail_t &trail) {
   for (auto cid : cnf) {
     if (trail.clause_sat(cnf[cid])) continue;
@@ -338,7 +284,7 @@ clause_id trail_t::get_unit_clause(const cnf_t &cnf, const trail_t &trail) {
     assert(c);
     if (c == 1) return cid;
   }
-  return nullptr;
+  return null_clause_id;
 }
 bool trail_t::is_satisfied(const cnf_t &cnf, const trail_t &trail) {
   return std::all_of(std::begin(const_clauses(cnf)),
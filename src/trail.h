@@ -2,30 +2,34 @@
 #include <memory>
 #include "action.h"
 
+// Everything we record when a variable is assigned, in one place.
 struct var_data_t {
-  size_t level = 0;
-  action_t *cause = nullptr;
-  size_t dimacs = 0;
-  bool is_set = false;
-  bool is_true = false;
+  uint32_t level = 0;
+  // The index (into the trail) of the action that assigned us.
+  uint32_t reason = 0;
+  // The value our positive literal had the last time we were assigned (1 or
+  // -1), or 0 if we never have been. This is kept after we're unassigned.
+  int8_t phase = 0;
 };
 
 // This data structure captures the actual state our partial assignment.
 struct trail_t {
-  enum class v_state_t { unassigned, var_true, var_false };
-  literal_map_t<v_state_t> litstate;
-  literal_map_t<v_state_t> oldlitstate;
-  literal_map_t<action_t *> lit_to_action;
+  // 1 if the literal is true, -1 if false, 0 if unassigned. This is the
+  // innermost check of propagation, so it's a single byte load.
+  literal_map_t<int8_t> value;
+  var_map_t<var_data_t> vardata;
   std::vector<action_t> mem;
-  var_map_t<size_t> varlevel;
-  var_bitset_t varset;
 
   size_t next_index = 0;
   size_t size = 0;
   size_t dlevel = 0;
+  // The propagation head: actions before this have had their consequences
+  // found; those from here to the end are assigned but not yet propagated.
+  // Implied literals go straight onto the trail, so this is our unit queue.
+  size_t prop_head = 0;
 
   trail_t(const trail_t &t) = delete;
-  trail_t() : litstate(0), oldlitstate(0), lit_to_action(0) {}
+  trail_t() : value(0) {}
   void construct(size_t max_var);
 
   const action_t *cbegin() const { return &(mem[0]); }
@@ -45,6 +49,7 @@ struct trail_t {
   const auto rend() const { return std::make_reverse_iterator(begin()); }
 
   bool empty() const { return next_index == 0; }
+  bool fully_propagated() const { return prop_head == next_index; }
 
   void append(action_t a);
   action_t pop();
@@ -57,9 +62,10 @@ struct trail_t {
   bool conflicted() const {
     return rbegin() != rend() && rbegin()->is_conflict();
   }
-  bool literal_true(const literal_t l) const;
-  bool literal_false(const literal_t l) const;
-  bool literal_unassigned(const literal_t l) const;
+  bool literal_true(const literal_t l) const { return value[l] > 0; }
+  bool literal_false(const literal_t l) const { return value[l] < 0; }
+  bool literal_unassigned(const literal_t l) const { return value[l] == 0; }
+  bool var_assigned(const variable_t v) const { return value[lit(v)] != 0; }
   literal_t previously_assigned_literal(variable_t v) const;
 
   bool clause_unsat(const clause_t &c) const;
@@ -71,12 +77,12 @@ struct trail_t {
   literal_t find_unassigned_literal(const clause_t &c) const;
   literal_t find_last_falsified(const clause_t &c) const;
   bool uses_clause(const clause_id cid) const;
+  bool is_reason(const clause_id cid, const clause_t &c) const;
 
   action_t cause(literal_t l) const;
   bool contains_clause(clause_id cid) const;
 
   static void validate(const cnf_t &cnf, const trail_t &trail);
-  void print_certificate() const;
 
   static bool has_unit(const cnf_t &cnf, const trail_t &trail);
   static clause_id get_unit_clause(const cnf_t &cnf, const trail_t &trail);
@@ -86,7 +92,4 @@ struct trail_t {
   static bool is_indeterminate(const cnf_t &cnf, const trail_t &t);
 };
 
-std::ostream &operator<<(std::ostream &o, const trail_t::v_state_t s);
-std::ostream &operator<<(std::ostream &o,
-                         const std::vector<trail_t::v_state_t> &s);
 std::ostream &operator<<(std::ostream &o, const trail_t &t);
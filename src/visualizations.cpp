@@ -86,8 +86,8 @@ std::map<size_t, std::set<std::string>> layers;
 bool operator<(const action_t &a, const action_t b) {
   assert(a.has_literal() || a.has_clause());
   assert(b.has_literal() || b.has_clause());
-  std::pair<clause_id, literal_t> ap = {nullptr, 0};
-  std::pair<clause_id, literal_t> bp = {nullptr, 0};
+  std::pair<clause_id, literal_t> ap = {null_clause_id, 0};
+  std::pair<clause_id, literal_t> bp = {null_clause_id, 0};
   if (a.has_literal()) {
     ap.second = a.get_literal();
   }
@@ -1,5 +1,7 @@
 #include <chrono>
 #include "measurements.h"
+#include "occurrences.h"
+#include "proof.h"
 #include "settings.h"
 #include "solver.h"
 
@@ -10,20 +12,33 @@
 // situation where it's worth it. Maybe with better filtering/heuristics.
 struct vivifier_t {
   cnf_t &cnf;
-  clause_id to_skip = nullptr;
+  clause_id to_skip = null_clause_id;
   trail_t trail;
   const_watched_literals_t watch;
-  unit_queue_t unit_queue;
   solver_t *solver = nullptr;
 
   plugin<literal_t> apply_decision;
   plugin<literal_t, clause_id> apply_unit;
 
+  // If given, every literal we take out of a clause.
+  std::vector<std::pair<clause_id, literal_t>> *removed = nullptr;
+
+  // Cuts the clause down to its first n literals.
+  void truncate(clause_id cid, size_t n) {
+    clause_t &c = cnf[cid];
+    proof::truncate(c, n);
+    while (c.size() > n) {
+      if (removed) removed->push_back({cid, c[c.size() - 1]});
+      c.pop_back();
+    }
+  }
+
+  // As in the solver, units go straight onto the trail and apply_unit is
+  // called as the propagation head passes them.
   void install_core_plugins() {
-    apply_decision.add_listener(
-        [&](literal_t l) { trail.append(make_decision(l)); });
-    apply_unit.add_listener([&](literal_t l, clause_id cid) {
-      trail.append(make_unit_prop(l, cid));
+    apply_decision.add_listener([&](literal_t l) {
+      trail.append(make_decision(l));
+      trail.prop_head = trail.next_index;
     });
   }
   void install_watched_literals() {
@@ -31,14 +46,9 @@ struct vivifier_t {
       // TODO: we should be filtering out units aggressively?
       if (cnf[cid].size() > 1) watch.watch_clause(cid);
     }
-    apply_decision.add_listener([&](literal_t l) {
-      watch.literal_falsed(l);
-      MAX_ASSERT(halted() || watch.validate_state(to_skip));
-    });
-    apply_unit.add_listener([&](literal_t l, clause_id cid) {
-      watch.literal_falsed(l);
-      MAX_ASSERT(halted() || watch.validate_state(to_skip));
-    });
+    apply_decision.add_listener([&](literal_t l) { watch.literal_falsed(l); });
+    apply_unit.add_listener(
+        [&](literal_t l, clause_id cid) { watch.literal_falsed(l); });
   }
   bool halt_state(const action_t action) const {
     return action.action_kind == action_t::action_kind_t::halt_conflict ||
@@ -50,21 +60,12 @@ struct vivifier_t {
     return result;
   }
   bool drain_units() {
-    bool did_work = false;
-    while (!unit_queue.empty()) {
-      did_work = true;
-      // action_t a = unit_queue.pop();
-      // literal_t l = a.get_literal();
-      // clause_id c = a.get_clause;
-      auto e = unit_queue.pop();
-      literal_t l = e.l;
-      clause_id c = e.c;
-      if (!trail.literal_unassigned(l)) continue;
-      apply_unit(l, c);
-      if (halted()) {
-        break;
-      }
+    bool did_work = !trail.fully_propagated() || halted();
+    while (!halted() && !trail.fully_propagated()) {
+      const action_t a = trail.mem[trail.prop_head++];
+      apply_unit(a.get_literal(), a.get_clause());
     }
+    MAX_ASSERT(halted() || watch.validate_state(to_skip));
     return did_work;
   }
 
@@ -81,7 +82,7 @@ struct vivifier_t {
     // This is simulating "cnf \ c".
     if (solver) {
       // if this is on the "real" trail, dont use it.
-      if (solver->trail.uses_clause(cid)) return false;
+      if (solver->trail.is_reason(cid, c)) return false;
       // solver->remove_clause(cid);
       solver->watch.remove_clause(cid);
     }
@@ -106,10 +107,7 @@ struct vivifier_t {
         if (std::next(it) != std::end(c)) {
           cond_log(settings::trace_vivification,
                    solver_action::vivification_case_1_pre, c);
-          auto to_erase = std::distance(std::next(it), std::end(c));
-          for (auto i = 0; i < to_erase; i++) {
-            c.pop_back();
-          }
+          truncate(cid, std::distance(std::begin(c), std::next(it)));
           cond_log(settings::trace_vivification,
                    solver_action::vivification_case_1_post, c);
           did_work = true;
@@ -133,7 +131,7 @@ struct vivifier_t {
         cond_log(settings::trace_vivification,
                  solver_action::vivification_case_2a_pre, c);
         std::iter_swap(jt, std::prev(std::end(c)));
-        c.pop_back();
+        truncate(cid, c.size() - 1);
         cond_log(settings::trace_vivification,
                  solver_action::vivification_case_2a_post, c);
         did_work = true;
@@ -151,10 +149,7 @@ struct vivifier_t {
 
           // Erase everything after that
           // c.erase(std::next(it), std::end(c));
-          auto to_erase = std::distance(std::next(it), std::end(c));
-          for (auto i = 0; i < to_erase; i++) {
-            c.pop_back();
-          }
+          truncate(cid, std::distance(std::begin(c), std::next(it)));
           cond_log(settings::trace_vivification,
                    solver_action::vivification_case_2b_post, c);
           did_work = true;
@@ -165,7 +160,6 @@ struct vivifier_t {
 
     // reset completely.
     trail.drop_from(std::begin(trail));
-    unit_queue.clear();
 
     if (c.size() > 1) watch.watch_clause(cid);
     if (solver) {
@@ -178,16 +172,16 @@ struct vivifier_t {
     return did_work;
   }
 
-  bool vivify() {
+  bool vivify() { return vivify({std::begin(cnf), std::end(cnf)}); }
+
+  bool vivify(const std::vector<clause_id> &worklist) {
     // Loop until quiescent.
     // Report if there's any change.
     bool change = false;
 
-    // The iterator we use here shouldn't be invalidated by vivify.
     bool continue_iterating = true;
     while (continue_iterating) {
       continue_iterating = false;
-      std::vector<clause_id> worklist{std::begin(cnf), std::end(cnf)};
       for (auto cid : worklist) {
         if (vivify(cid)) {
           cond_log(settings::trace_vivification, cnf[cid]);
@@ -200,7 +194,7 @@ struct vivifier_t {
   }
 
   vivifier_t(cnf_t &CNF, solver_t *solver = nullptr)
-      : cnf(CNF), watch(cnf, trail, unit_queue), solver(solver) {
+      : cnf(CNF), watch(cnf, trail), solver(solver) {
     variable_t max_var = max_variable(cnf);
     trail.construct(max_var);
     install_core_plugins();
@@ -220,3 +214,28 @@ bool VIV(cnf_t &cnf, solver_t *solver = nullptr) {
   bool result = viv.vivify();
   return result;
 }
+
+// For the preprocessor: only clauses with a candidate variable are vivified,
+// and occ is told what they lost. Returns how many literals that was.
+size_t VIV(occurrences_t &occ, const std::vector<variable_t> &candidates) {
+  cnf_t &cnf = occ.cnf;
+  std::vector<uint8_t> queued(cnf.arena.limit(), false);
+  std::vector<clause_id> worklist;
+  for (variable_t v : candidates) {
+    for (literal_t l : {lit(v), neg(lit(v))}) {
+      for (clause_id cid : occ[l]) {
+        if (queued[cid]) continue;
+        queued[cid] = true;
+        worklist.push_back(cid);
+      }
+    }
+  }
+  if (worklist.empty()) return 0;
+
+  std::vector<std::pair<clause_id, literal_t>> removed;
+  vivifier_t viv(cnf);
+  viv.removed = &removed;
+  viv.vivify(worklist);
+  occ.removed_literals(removed);
+  return removed.size();
+}
@@ -0,0 +1,85 @@
+#include "vmtf.h"
+
+#include <algorithm>
+
+vmtf_t::vmtf_t(const cnf_t &cnf, const trail_t &trail)
+    : trail(trail), vars(cnf.var_range()) {
+  links.construct(max_variable(cnf));
+  stamp.construct(max_variable(cnf));
+  for (variable_t v : vars) {
+    enqueue(v);
+  }
+  search = last;
+}
+
+void vmtf_t::dequeue(variable_t v) {
+  link_t &l = links[v];
+  if (l.prev) {
+    links[l.prev].next = l.next;
+  } else {
+    first = l.next;
+  }
+  if (l.next) {
+    links[l.next].prev = l.prev;
+  } else {
+    last = l.prev;
+  }
+  l.prev = l.next = 0;
+}
+
+void vmtf_t::enqueue(variable_t v) {
+  link_t &l = links[v];
+  l.prev = last;
+  l.next = 0;
+  if (last) {
+    links[last].next = v;
+  } else {
+    first = v;
+  }
+  last = v;
+  stamp[v] = ++next_stamp;
+}
+
+// Deferred to clause_learned (see to_bump).
+void vmtf_t::bump_variable(variable_t v) { to_bump.push_back(v); }
+
+void vmtf_t::clause_learned(const clause_t &c) {
+  for (literal_t l : c) {
+    to_bump.push_back(var(l));
+  }
+  std::sort(std::begin(to_bump), std::end(to_bump),
+            [&](variable_t a, variable_t b) { return stamp[a] < stamp[b]; });
+  to_bump.erase(std::unique(std::begin(to_bump), std::end(to_bump)),
+                std::end(to_bump));
+  for (variable_t v : to_bump) {
+    if (v == last) {
+      stamp[v] = ++next_stamp;
+    } else {
+      dequeue(v);
+      enqueue(v);
+    }
+    if (!trail.var_assigned(v)) {
+      search = v;
+    }
+  }
+  to_bump.clear();
+}
+
+void vmtf_t::unassigned(variable_t v) {
+  if (before(v, search)) {
+    search = v;
+  }
+}
+
+variable_t vmtf_t::peek() {
+  while (search && trail.var_assigned(search)) {
+    search = links[search].prev;
+  }
+  return search;
+}
+
+literal_t vmtf_t::choose() {
+  variable_t v = peek();
+  if (!v) return 0;
+  return trail.previously_assigned_literal(v);
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "trail.h"
+
+// Variable move-to-front, as in CaDiCaL's focused mode. Variables sit in a
+// doubly linked queue; bumping one moves it to the back (the "front" we
+// decide from) and gives it a fresh timestamp. We cache where the search for
+// an unassigned variable can start: everything after it in the queue is
+// assigned. Unassigning a variable with a later timestamp moves it back.
+// So bumping is O(1) per variable, and deciding is amortized O(1).
+struct vmtf_t {
+  vmtf_t(const cnf_t &cnf, const trail_t &trail);
+  void bump_variable(variable_t v);
+  void clause_learned(const clause_t &c);
+  void unassigned(variable_t v);
+  literal_t choose();
+  variable_t peek();
+
+  const trail_t &trail;
+  variable_range vars;
+
+  struct link_t {
+    variable_t prev = 0;
+    variable_t next = 0;
+  };
+  var_map_t<link_t> links;
+  var_map_t<uint64_t> stamp;
+  uint64_t next_stamp = 0;
+  variable_t first = 0;
+  variable_t last = 0;
+  variable_t search = 0;
+
+  // The variables analysis has touched since the last learned clause; we
+  // bump them in the order of their old timestamps, so they keep their
+  // relative order.
+  std::vector<variable_t> to_bump;
+
+  bool before(variable_t a, variable_t b) const { return stamp[a] > stamp[b]; }
+  void dequeue(variable_t v);
+  void enqueue(variable_t v);
+};
@@ -36,7 +36,7 @@ literal_t vsids_t::choose() const {
   variable_t c = 0;
   float a = -1;
   for (variable_t v : vars) {
-    if (trail.varset.get(v)) continue;
+    if (trail.var_assigned(v)) continue;
     if (activity[v] >= a) {
       a = activity[v];
       c = v;
@@ -49,71 +49,148 @@ float vsids_t::score(literal_t l) const { return activity[var(l)]; }
 
 vsids_heap_t::vsids_heap_t(const cnf_t &cnf, const trail_t &trail)
     : trail(trail), cnf(cnf), vars(cnf.var_range()) {
-  mem = std::make_unique<heap_node[]>(vars.max_var);
   activity.construct(max_variable(cnf));
-  for (variable_t v : vars) {
-    activity[v] = &mem[v - 1];
-    activity[v]->var = v;
-    heap.push_back(&mem[v - 1]);
-    n++;
-  }
-  heap_end = std::end(heap);
+  heap_index.construct(max_variable(cnf));
+  heap.reserve(vars.max_var);
   static_activity();
 }
 
-bool vsids_heap_t::heap_cmp(heap_node *a, heap_node *b) {
-  return a->activity < b->activity;
-}
-
 void vsids_heap_t::static_activity() {
   clear_activity();
   for (auto cid : cnf) {
     for (auto l : cnf[cid]) {
-      activity[var(l)]->activity += bump;
+      activity[var(l)] += 1.0;
     }
   }
-  heap_end = std::end(heap);
-  std::make_heap(std::begin(heap), heap_end, heap_cmp);
+  rebuild();
 }
 
 void vsids_heap_t::clear_activity() {
-  std::for_each(mem.get(), mem.get() + n, [](heap_node &m) { m.activity = 0; });
+  std::fill(std::begin(activity), std::end(activity), 0.0);
+  bump = 1.0;
+}
+
+void vsids_heap_t::bump_variable(variable_t v) {
+  activity[v] += bump;
+  if (activity[v] > rescale_limit) {
+    rescale();
+  }
+  if (in_heap(v)) {
+    sift_up(heap_index[v]);
+  }
+}
+
+// Scaling everything by the same factor keeps the heap order intact.
+void vsids_heap_t::rescale() {
+  for (double &a : activity) {
+    a *= 1 / rescale_limit;
+  }
+  bump *= 1 / rescale_limit;
 }
 
 void vsids_heap_t::clause_learned(const clause_t &c) {
   for (literal_t l : c) {
-    activity[var(l)]->activity += bump;
+    bump_variable(var(l));
   }
-
-  // TODO: is there a way to only call this sometimes?
-  // We can also limit the range to the "lowest" we've incremented, but finding
-  // that is tricky.
-  heap_end = std::end(heap);
-  if (std::is_heap(std::begin(heap), heap_end, heap_cmp)) {
-    // printf("skipping\n");
-  } else {
-    std::make_heap(std::begin(heap), heap_end, heap_cmp);
+  // This is the "decay": future bumps count for more.
+  bump *= 1 / alpha;
+  if (bump > rescale_limit) {
+    rescale();
   }
+}
 
-  // don't ref the whole structure into the lambda... hopefully
-  // helps with alias analysis (in compiler optimizations).
-  float a = alpha;
-  std::for_each(mem.get(), mem.get() + n,
-                [a](heap_node &m) { m.activity *= a; });
+void vsids_heap_t::unassigned(variable_t v) {
+  if (!in_heap(v)) {
+    insert(v);
+  }
 }
+
 literal_t vsids_heap_t::choose() {
-  // assert(std::is_heap(std::begin(heap), heap_end, heap_cmp));
-  while (heap_end != std::begin(heap) && trail.varset.get(heap[0]->var)) {
-    std::pop_heap(std::begin(heap), heap_end, heap_cmp);
-    heap_end--;
-  }
-  if (heap_end == std::begin(heap)) {
-    return 0;
-  }
-  // assert(std::all_of(heap_end, std::end(heap),
-  //[&](heap_node *n) { return trail.varset.get(n->var); }));
-  variable_t c = heap[0]->var;
-  std::pop_heap(std::begin(heap), heap_end, heap_cmp);
-  heap_end--;
-  return trail.previously_assigned_literal(c);
-}
\ No newline at end of file
+  // Assigned variables are only removed from the heap as they surface.
+  while (!heap.empty()) {
+    variable_t c = pop_max();
+    if (!trail.var_assigned(c)) {
+      return trail.previously_assigned_literal(c);
+    }
+  }
+  return 0;
+}
+
+// The variable choose() would pick (0 if none), without picking it.
+variable_t vsids_heap_t::peek() {
+  while (!heap.empty() && trail.var_assigned(heap[0])) {
+    pop_max();
+  }
+  return heap.empty() ? 0 : heap[0];
+}
+
+float vsids_heap_t::score(literal_t l) const { return activity[var(l)]; }
+
+void vsids_heap_t::rebuild() {
+  heap.clear();
+  std::fill(std::begin(heap_index), std::end(heap_index), -1);
+  for (variable_t v : vars) {
+    heap_index[v] = heap.size();
+    heap.push_back(v);
+  }
+  for (size_t i = heap.size() / 2; i-- > 0;) {
+    sift_down(i);
+  }
+}
+
+void vsids_heap_t::insert(variable_t v) {
+  heap_index[v] = heap.size();
+  heap.push_back(v);
+  sift_up(heap.size() - 1);
+}
+
+// activity[v] has changed (either way); restore the heap order.
+void vsids_heap_t::update(variable_t v) {
+  if (in_heap(v)) {
+    sift_up(heap_index[v]);
+    sift_down(heap_index[v]);
+  }
+}
+
+variable_t vsids_heap_t::pop_max() {
+  variable_t top = heap[0];
+  heap_index[top] = -1;
+  variable_t last = heap.back();
+  heap.pop_back();
+  if (!heap.empty()) {
+    heap[0] = last;
+    heap_index[last] = 0;
+    sift_down(0);
+  }
+  return top;
+}
+
+// These move a "hole" rather than swapping at each step.
+void vsids_heap_t::sift_up(size_t i) {
+  variable_t v = heap[i];
+  while (i > 0) {
+    size_t parent = (i - 1) / 2;
+    if (!before(v, heap[parent])) break;
+    heap[i] = heap[parent];
+    heap_index[heap[i]] = i;
+    i = parent;
+  }
+  heap[i] = v;
+  heap_index[v] = i;
+}
+
+void vsids_heap_t::sift_down(size_t i) {
+  variable_t v = heap[i];
+  const size_t n = heap.size();
+  for (;;) {
+    size_t child = 2 * i + 1;
+    if (child >= n) break;
+    if (child + 1 < n && before(heap[child + 1], heap[child])) child++;
+    if (!before(heap[child], v)) break;
+    heap[i] = heap[child];
+    heap_index[heap[i]] = i;
+    i = child;
+  }
+  heap[i] = v;
+  heap_index[v] = i;
+}
@@ -25,25 +25,45 @@ struct vsids_t {
   const trail_t &trail;
 };
 
+// EVSIDS, as in MiniSat. Rather than decaying every activity after each
+// conflict, we grow the bump by 1/alpha, which preserves the ordering; when
+// activities get too big to be safe, we rescale everything once. Unassigned
+// variables (and some assigned ones, lazily) sit in an indexed binary max-heap,
+// so choosing is logarithmic. Variables are reinserted as they're unassigned.
 struct vsids_heap_t {
-  struct heap_node {
-    variable_t var;
-    float activity;
-  };
   vsids_heap_t(const cnf_t &cnf, const trail_t &trail);
-  static bool heap_cmp(heap_node *a, heap_node *b);
   void static_activity();
   void clear_activity();
+  void bump_variable(variable_t v);
   void clause_learned(const clause_t &c);
+  void unassigned(variable_t v);
   literal_t choose();
-  const float alpha = 0.95f;
-  const float bump = 1.0f;
+  variable_t peek();
+  float score(literal_t l) const;
+
+  // Stable mode turns this up (see solver_t::switch_mode).
+  double alpha = 0.95;
+  const double rescale_limit = 1e100;
+  double bump = 1.0;
+
   const trail_t &trail;
   const cnf_t &cnf;
-  std::unique_ptr<heap_node[]> mem;
-  size_t n = 0;
-  std::vector<heap_node *> heap;
-  std::vector<heap_node *>::iterator heap_end;
-  var_map_t<heap_node *> activity;
   variable_range vars;
-};
\ No newline at end of file
+  var_map_t<double> activity;
+
+  // The heap proper, and where each variable is in it (-1 if it isn't).
+  std::vector<variable_t> heap;
+  var_map_t<int> heap_index;
+
+  bool in_heap(variable_t v) const { return heap_index[v] >= 0; }
+  bool before(variable_t a, variable_t b) const {
+    return activity[a] > activity[b];
+  }
+  void insert(variable_t v);
+  void update(variable_t v);
+  variable_t pop_max();
+  void sift_up(size_t i);
+  void sift_down(size_t i);
+  void rebuild();
+  void rescale();
+};
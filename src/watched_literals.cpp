@@ -8,22 +8,16 @@
 void watched_literals_t::install(solver_t &s)
 //: cnf(s.cnf),
 // trail(s.trail),
-// units(s.unit_queue),
 // literals_to_watcher(max_variable(s.cnf))
 {
   for (clause_id cid : s.cnf) {
     watch_clause(cid);
   }
 
-  s.apply_decision.add_listener([&](literal_t l) {
-    literal_falsed(l);
-    MAX_ASSERT(trail.conflicted() || validate_state());
-  });
-  s.apply_unit.add_listener([&](literal_t l, clause_id cid) {
-    literal_falsed(l);
-    MAX_ASSERT(trail.conflicted() || validate_state());
-  });
+  // apply_decision and apply_unit call literal_falsed directly, from the
+  // solver's fixed core (see core_apply_unit_t).
   s.remove_clause.add_listener([&](clause_id cid) { remove_clause(cid); });
+  s.relocate_clauses.add_listener([&](cnf_t &cnf) { relocate_clauses(); });
 
   s.added_clause.add_listener([&](const trail_t &trail, clause_id cid) {
     const clause_t &c = cnf[cid];
@@ -40,12 +34,11 @@ void watched_literals_t::install(solver_t &s)
   MAX_ASSERT(validate_state());
 }
 
-watched_literals_t::watched_literals_t(cnf_t &cnf, trail_t &trail,
-                                       unit_queue_t &units)
+watched_literals_t::watched_literals_t(cnf_t &cnf, trail_t &trail)
     : cnf(cnf),
       trail(trail),
-      units(units),
-      literals_to_watcher(max_variable(cnf)) {}
+      literals_to_watcher(max_variable(cnf)),
+      binary_implications(max_variable(cnf)) {}
 
 auto watched_literals_t::find_watcher(const clause_t &c, literal_t o /*= 0*/) {
   for (auto it = std::begin(c); it != std::end(c); it++) {
@@ -90,6 +83,12 @@ void watched_literals_t::watch_clause(clause_id cid) {
   clause_t &c = cnf[cid];
   SAT_ASSERT(c.size() > 1);
 
+  if (c.size() == 2) {
+    binary_implications[c[0]].push_back({c[1], cid});
+    binary_implications[c[1]].push_back({c[0], cid});
+    return;
+  }
+
   // Find a non-false watcher; one should exist.
   literal_t l1 = find_initial_watcher(c);
   literal_t l2 = find_initial_watcher(c, l1);
@@ -116,6 +115,17 @@ void watched_literals_t::literal_falsed(literal_t l) {
   literal_t ul = neg(l);
   SAT_ASSERT(trail.literal_false(ul));
 
+  // Binary clauses first: no clause to look at, just the implied literals.
+  for (const implication_t &b : binary_implications[ul]) {
+    if (trail.literal_true(b.implied)) continue;
+    if (trail.literal_false(b.implied)) {
+      SAT_ASSERT(trail.clause_unsat(cnf[b.cid]));
+      trail.append(make_conflict(b.cid));
+      return;
+    }
+    trail.append(make_unit_prop(b.implied, b.cid));
+  }
+
   auto &watchers = literals_to_watcher[ul];
 
   int s = watchers.size();
@@ -192,12 +202,13 @@ void watched_literals_t::literal_falsed(literal_t l) {
         SAT_ASSERT(trail.literal_unassigned(ol));
         SAT_ASSERT(trail.count_unassigned_literals(c) == 1);
         SAT_ASSERT(trail.find_unassigned_literal(c) == ol);
-        units.push({ol, cid});
+        trail.append(make_unit_prop(ol, cid));
       }
     }
   }
   watchers.resize(j);
-  MAX_ASSERT(trail.conflicted() || validate_state());
+  MAX_ASSERT(trail.conflicted() || !trail.fully_propagated() ||
+             validate_state());
 }
 
 void watched_literals_t::unwatch_clause(literal_t l, clause_id cid) {
@@ -212,15 +223,43 @@ void watched_literals_t::unwatch_clause(literal_t l, clause_id cid) {
              }) == std::end(lst));
 }
 
+void watched_literals_t::unwatch_binary(literal_t l, clause_id cid) {
+  auto &lst = binary_implications[l];
+  auto it = std::find_if(std::begin(lst), std::end(lst),
+                         [cid](auto &b) { return b.cid == cid; });
+  SAT_ASSERT(it != std::end(lst));
+  std::iter_swap(it, std::prev(std::end(lst)));
+  lst.pop_back();
+}
+
 void watched_literals_t::remove_clause(clause_id cid) {
   if (!clause_watched(cid)) return;
-  if (!cid->is_alive) return;
+  if (!cnf[cid].is_alive) return;
   const clause_t &c = cnf[cid];
 
+  if (c.size() == 2) {
+    unwatch_binary(c[0], cid);
+    unwatch_binary(c[1], cid);
+    return;
+  }
   unwatch_clause(c[0], cid);
   unwatch_clause(c[1], cid);
 }
 
+// Clauses that share a watch list end up next to each other.
+void watched_literals_t::relocate_clauses() {
+  for (auto &watchers : literals_to_watcher) {
+    for (auto &w : watchers) {
+      w.first = cnf.relocate(w.first);
+    }
+  }
+  for (auto &implications : binary_implications) {
+    for (auto &b : implications) {
+      b.cid = cnf.relocate(b.cid);
+    }
+  }
+}
+
 void watched_literals_t::print_watch_state() {
   for (auto cid : cnf) {
     if (!clause_watched(cid)) continue;
@@ -236,6 +275,9 @@ void watched_literals_t::print_watch_state() {
       const clause_t &c = cnf[wp.first];
       std::cerr << "{" << c << "}; ";
     }
+    for (const auto &b : binary_implications[l]) {
+      std::cerr << "{" << cnf[b.cid] << "}; ";
+    }
     std::cerr << std::endl;
   }
 }
@@ -253,6 +295,21 @@ bool watched_literals_t::validate_state(clause_id skip_id) {
     }
     MAX_ASSERT(clause_watched(cid));
 
+    // Binary clauses are always in both implication lists, and there's no
+    // lazy state to worry about: a false literal means the other one is
+    // true, or is waiting past the trail's propagation head.
+    if (c.size() == 2) {
+      for (int k = 0; k < 2; k++) {
+        const auto &bl = binary_implications[c[k]];
+        MAX_ASSERT(std::count_if(std::begin(bl), std::end(bl), [&](auto &b) {
+                     return b.cid == cid && b.implied == c[1 - k];
+                   }) == 1);
+        (void)bl;
+      }
+      MAX_ASSERT(!trail.clause_unsat(c));
+      continue;
+    }
+
     // TODO: Something to enforce about expected effect of backtracking
     // (the relative order of watched literals, etc. etc.)
 
@@ -346,7 +403,6 @@ bool watched_literals_t::validate_state(clause_id skip_id) {
 void const_watched_literals_t::install(solver_t &s)
 //: cnf(s.cnf),
 // trail(s.trail),
-// units(s.unit_queue),
 // literals_to_watcher(max_variable(s.cnf))
 {
   for (clause_id cid : s.cnf) {
@@ -378,11 +434,9 @@ void const_watched_literals_t::install(solver_t &s)
   MAX_ASSERT(validate_state());
 }
 
-const_watched_literals_t::const_watched_literals_t(cnf_t &cnf, trail_t &trail,
-                                                   unit_queue_t &units)
+const_watched_literals_t::const_watched_literals_t(cnf_t &cnf, trail_t &trail)
     : cnf(cnf),
       trail(trail),
-      units(units),
       literals_to_watcher(max_variable(cnf)) {}
 
 auto const_watched_literals_t::find_watcher(const clause_t &c,
@@ -507,7 +561,7 @@ void const_watched_literals_t::literal_falsed(literal_t l) {
         MAX_ASSERT(trail.literal_unassigned(ol));
         MAX_ASSERT(trail.count_unassigned_literals(c) == 1);
         MAX_ASSERT(trail.find_unassigned_literal(c) == ol);
-        units.push({ol, cid});
+        trail.append(make_unit_prop(ol, cid));
       }
     }
   }
@@ -531,7 +585,7 @@ void const_watched_literals_t::unwatch_clause(literal_t l, clause_id cid) {
 
 void const_watched_literals_t::remove_clause(clause_id cid) {
   if (!clause_watched(cid)) return;
-  if (!cid->is_alive) return;
+  if (!cnf[cid].is_alive) return;
   watcher_t w = watched_literals[cid];
 
   unwatch_clause(w.l1, cid);
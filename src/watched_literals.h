@@ -6,15 +6,15 @@
 #include "cnf.h"
 #include "debug.h"
 #include "trail.h"
-#include "unit_queue.h"
 
 // This is ONLY for binary+ clauses, not unary or empty.
 // The main entry points:
 //  - watch_clause(cid): add a new clause to be watched
 //  - literal_falsed(l): inform the machine that a new literal has been marked
 //  false.
-//                       This will add more things to the unit-prop queue, or
-//                       report a conflict.
+//                       This will assign implied literals directly on the
+//                       trail (past its propagation head), or report a
+//                       conflict.
 
 struct trace_t;
 struct solver_t;
@@ -22,30 +22,40 @@ struct solver_t;
 struct watched_literals_t {
   cnf_t &cnf;
   trail_t &trail;
-  unit_queue_t &units;
   literal_map_t<std::vector<std::pair<clause_id, literal_t>>>
       literals_to_watcher;
 
+  // Binary clauses don't need watches that move: both literals are always
+  // "watched". So we keep them apart, as a plain implication graph: when l is
+  // falsified, each entry of binary_implications[l] names the implied literal
+  // directly. We only keep the clause_id around to report it as the reason.
+  struct implication_t {
+    literal_t implied;
+    clause_id cid;
+  };
+  literal_map_t<std::vector<implication_t>> binary_implications;
+
   void install(solver_t &);
-  watched_literals_t(cnf_t &cnf, trail_t &t, unit_queue_t &q);
+  watched_literals_t(cnf_t &cnf, trail_t &t);
   void watch_clause(clause_id cid);
   void literal_falsed(literal_t l);
 
   bool clause_watched(clause_id cid);
 
   void unwatch_clause(literal_t l, clause_id cid);
+  void unwatch_binary(literal_t l, clause_id cid);
   void remove_clause(clause_id cid);
+  void relocate_clauses();
 
   literal_t find_initial_watcher(const clause_t &c, literal_t alt = 0);
   auto find_watcher(const clause_t &c, literal_t o = 0);
-  bool validate_state(clause_id skip_id = nullptr);
+  bool validate_state(clause_id skip_id = null_clause_id);
   void print_watch_state();
 };
 
 struct const_watched_literals_t {
   const cnf_t &cnf;
   trail_t &trail;
-  unit_queue_t &units;
   using watch_list_t = std::vector<std::pair<clause_id, literal_t>>;
   literal_map_t<watch_list_t> literals_to_watcher;
   struct watcher_t {
@@ -54,7 +64,7 @@ struct const_watched_literals_t {
   clause_map_t<watcher_t> watched_literals;
 
   void install(solver_t &);
-  const_watched_literals_t(cnf_t &cnf, trail_t &t, unit_queue_t &q);
+  const_watched_literals_t(cnf_t &cnf, trail_t &t);
   void watch_clause(clause_id cid);
   void literal_falsed(literal_t l);
 
@@ -65,7 +75,7 @@ struct const_watched_literals_t {
 
   auto find_watcher(const clause_t &c, literal_t o = 0);
   void print_watch_state();
-  bool validate_state(clause_id skip_id = nullptr);
+  bool validate_state(clause_id skip_id = null_clause_id);
 };
 
 std::ostream &operator<<(std::ostream &o, const watched_literals_t &w);